@@ -0,0 +1,276 @@
+/**
+ * GNSSFilter.cpp - Position filter stage for QuectelEC200U GNSS fixes
+ *
+ * The filter runs in a local east/north tangent plane anchored at the first
+ * fix. With isotropic position noise (hdop * uere) and isotropic velocity
+ * noise the two axes are independent, so the 4-state model is evaluated as
+ * two 2-state filters: no matrix inversions, 3 floats of covariance per axis.
+ *
+ * Author: ESP32 Arduino Library
+ * Date: 2024
+ */
+
+#include "GNSSFilter.h"
+
+#define METERS_PER_DEG_LAT 111319.49f
+#define KMH_TO_MPS (1.0f / 3.6f)
+#define REANCHOR_DISTANCE_M 5000.0f
+#define DEG_TO_RAD_F 0.017453292f
+
+GNSSKalmanFilter::GNSSKalmanFilter(float uereMeters, float accelNoiseMps2, float gateChi2) {
+    uere = uereMeters;
+    accelNoise = accelNoiseMps2;
+    gateThreshold = gateChi2;
+    speedNoise = 0.5f;
+    maxGapMs = 30000;
+    maxRejects = 5;
+    stats.accepted = 0;
+    stats.rejected = 0;
+    stats.resets = 0;
+    initialized = false;
+    consecutiveRejects = 0;
+}
+
+void GNSSKalmanFilter::reset() {
+    if (initialized) {
+        stats.resets++;
+    }
+    initialized = false;
+    consecutiveRejects = 0;
+}
+
+void GNSSKalmanFilter::initialize(const GNSSPosition& position, unsigned long timestampMs) {
+    originLat = position.latitude;
+    originLon = position.longitude;
+    metersPerDegLon = METERS_PER_DEG_LAT * cosf((float)originLat * DEG_TO_RAD_F);
+
+    float hdop = (position.hdop > 0.5f) ? position.hdop : 0.5f;
+    float posVar = (hdop * uere) * (hdop * uere);
+    float speed = position.speedKmh * KMH_TO_MPS;
+    float course = position.courseOverGround * DEG_TO_RAD_F;
+    float velVar = speedNoise * speedNoise + 4.0f;  // Speed from a single fix is weak
+
+    east.p = 0;
+    east.v = speed * sinf(course);
+    east.p00 = posVar;
+    east.p01 = 0;
+    east.p11 = velVar;
+
+    north.p = 0;
+    north.v = speed * cosf(course);
+    north.p00 = posVar;
+    north.p01 = 0;
+    north.p11 = velVar;
+
+    lastTime = timestampMs;
+    consecutiveRejects = 0;
+    initialized = true;
+}
+
+void GNSSKalmanFilter::predict(Axis& axis, float dt) {
+    // White-noise acceleration model
+    float q = accelNoise * accelNoise;
+    float dt2 = dt * dt;
+
+    axis.p += axis.v * dt;
+    axis.p00 += dt * (2.0f * axis.p01 + dt * axis.p11) + q * dt2 * dt2 * 0.25f;
+    axis.p01 += dt * axis.p11 + q * dt2 * dt * 0.5f;
+    axis.p11 += q * dt2;
+}
+
+void GNSSKalmanFilter::updatePosition(Axis& axis, float z, float r) {
+    float s = axis.p00 + r;
+    float k0 = axis.p00 / s;
+    float k1 = axis.p01 / s;
+    float y = z - axis.p;
+
+    axis.p += k0 * y;
+    axis.v += k1 * y;
+    axis.p11 -= k1 * axis.p01;
+    axis.p00 *= (1.0f - k0);
+    axis.p01 *= (1.0f - k0);
+}
+
+void GNSSKalmanFilter::updateVelocity(Axis& axis, float z, float r) {
+    float s = axis.p11 + r;
+    float k0 = axis.p01 / s;
+    float k1 = axis.p11 / s;
+    float y = z - axis.v;
+
+    axis.p += k0 * y;
+    axis.v += k1 * y;
+    axis.p00 -= k0 * axis.p01;
+    axis.p01 -= k0 * axis.p11;
+    axis.p11 *= (1.0f - k1);
+}
+
+bool GNSSKalmanFilter::update(GNSSPosition& position, unsigned long timestampMs) {
+    if (!initialized || timestampMs - lastTime > maxGapMs) {
+        if (initialized) {
+            stats.resets++;
+        }
+        initialize(position, timestampMs);
+        stats.accepted++;
+        return true;
+    }
+
+    float dt = (timestampMs - lastTime) * 0.001f;
+    lastTime = timestampMs;
+    if (dt > 0) {
+        predict(east, dt);
+        predict(north, dt);
+    }
+
+    // Measurement in the local plane; only the degree difference needs double
+    float zEast = (float)(position.longitude - originLon) * metersPerDegLon;
+    float zNorth = (float)(position.latitude - originLat) * METERS_PER_DEG_LAT;
+    float hdop = (position.hdop > 0.5f) ? position.hdop : 0.5f;
+    float r = (hdop * uere) * (hdop * uere);
+
+    // Outlier gate on the position innovation
+    float yEast = zEast - east.p;
+    float yNorth = zNorth - north.p;
+    float d2 = yEast * yEast / (east.p00 + r) + yNorth * yNorth / (north.p00 + r);
+
+    bool accepted = (d2 <= gateThreshold);
+    if (accepted) {
+        consecutiveRejects = 0;
+        stats.accepted++;
+
+        updatePosition(east, zEast, r);
+        updatePosition(north, zNorth, r);
+
+        float speed = position.speedKmh * KMH_TO_MPS;
+        float course = position.courseOverGround * DEG_TO_RAD_F;
+        float rv = speedNoise * speedNoise;
+        updateVelocity(east, speed * sinf(course), rv);
+        updateVelocity(north, speed * cosf(course), rv);
+    } else {
+        stats.rejected++;
+        if (++consecutiveRejects >= maxRejects) {
+            // Persistent disagreement is a real jump (e.g. after a tunnel)
+            stats.resets++;
+            initialize(position, timestampMs);
+            return true;
+        }
+    }
+
+    // Keep the float state small by moving the origin along with the track
+    if (fabsf(east.p) > REANCHOR_DISTANCE_M || fabsf(north.p) > REANCHOR_DISTANCE_M) {
+        originLon += east.p / metersPerDegLon;
+        originLat += north.p / METERS_PER_DEG_LAT;
+        metersPerDegLon = METERS_PER_DEG_LAT * cosf((float)originLat * DEG_TO_RAD_F);
+        east.p = 0;
+        north.p = 0;
+    }
+
+    position.latitude = originLat + north.p / METERS_PER_DEG_LAT;
+    position.longitude = originLon + east.p / metersPerDegLon;
+    // The modem's strings no longer describe the position
+    position.latitudeStr = "";
+    position.longitudeStr = "";
+    return accepted;
+}
+
+void GNSSKalmanFilter::getVelocity(float& speedKmh, float& courseDeg) const {
+    if (!initialized) {
+        speedKmh = 0;
+        courseDeg = 0;
+        return;
+    }
+    speedKmh = sqrtf(east.v * east.v + north.v * north.v) * 3.6f;
+    courseDeg = atan2f(east.v, north.v) / DEG_TO_RAD_F;
+    if (courseDeg < 0) {
+        courseDeg += 360.0f;
+    }
+}
+
+// ========== Report Filter ==========
+
+GNSSReportFilter::GNSSReportFilter(float stopSpeedKmh, float driftRadiusMeters,
+                                   unsigned long stopDelayMs, unsigned long heartbeatMs) {
+    this->stopSpeedKmh = stopSpeedKmh;
+    driftRadius = driftRadiusMeters;
+    this->stopDelayMs = stopDelayMs;
+    this->heartbeatMs = heartbeatMs;
+    uere = 5.0f;
+    callback = nullptr;
+    callbackContext = nullptr;
+    stats.reported = 0;
+    stats.suppressed = 0;
+    stats.stops = 0;
+    reset();
+}
+
+void GNSSReportFilter::reset() {
+    stationary = false;
+    candidate = false;
+    candidateSince = 0;
+    lastReportTime = 0;
+    lastReason = GNSS_REPORT_NONE;
+}
+
+void GNSSReportFilter::setAnchor(const GNSSPosition& position) {
+    anchorLat = position.latitude;
+    anchorLon = position.longitude;
+    anchorMetersPerDegLon = METERS_PER_DEG_LAT * cosf((float)anchorLat * DEG_TO_RAD_F);
+}
+
+bool GNSSReportFilter::beyondDrift(const GNSSPosition& position) const {
+    // Noisy fixes get a wider radius (2 sigma) so they do not fake motion
+    float limit = driftRadius + 2.0f * position.hdop * uere;
+    float dx = (float)(position.longitude - anchorLon) * anchorMetersPerDegLon;
+    float dy = (float)(position.latitude - anchorLat) * METERS_PER_DEG_LAT;
+    return dx * dx + dy * dy > limit * limit;
+}
+
+GNSSReportReason GNSSReportFilter::report(const GNSSPosition& position, GNSSReportReason reason,
+                                          unsigned long timestampMs) {
+    lastReason = reason;
+    if (reason == GNSS_REPORT_NONE) {
+        stats.suppressed++;
+        return reason;
+    }
+    stats.reported++;
+    lastReportTime = timestampMs;
+    if (callback != nullptr) {
+        callback(position, reason, callbackContext);
+    }
+    return reason;
+}
+
+GNSSReportReason GNSSReportFilter::update(const GNSSPosition& position, unsigned long timestampMs) {
+    if (!position.valid) {
+        lastReason = GNSS_REPORT_NONE;
+        return GNSS_REPORT_NONE;
+    }
+
+    bool slow = position.speedKmh < stopSpeedKmh;
+
+    if (stationary) {
+        // Hysteresis on speed; drift is checked against the stop position
+        if (position.speedKmh >= 2.0f * stopSpeedKmh || beyondDrift(position)) {
+            stationary = false;
+            candidate = false;
+            return report(position, GNSS_REPORT_MOTION_START, timestampMs);
+        }
+        if (timestampMs - lastReportTime >= heartbeatMs) {
+            return report(position, GNSS_REPORT_HEARTBEAT, timestampMs);
+        }
+        return report(position, GNSS_REPORT_NONE, timestampMs);
+    }
+
+    if (!slow) {
+        candidate = false;
+    } else if (!candidate || beyondDrift(position)) {
+        // Slow but still creeping: restart the stop timer here
+        candidate = true;
+        candidateSince = timestampMs;
+        setAnchor(position);
+    } else if (timestampMs - candidateSince >= stopDelayMs) {
+        stationary = true;
+        stats.stops++;
+        return report(position, GNSS_REPORT_STOP, timestampMs);
+    }
+    return report(position, GNSS_REPORT_MOVING, timestampMs);
+}
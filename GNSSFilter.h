@@ -0,0 +1,208 @@
+/**
+ * GNSSFilter.h - Position filter stage for QuectelEC200U GNSS fixes
+ *
+ * Provides a constant-memory 2D constant-velocity Kalman filter that smooths
+ * the latitude/longitude of each fix and rejects multipath outliers with a
+ * Mahalanobis gate. Attach it with QuectelEC200U::setPositionFilter().
+ *
+ * GNSSReportFilter decides which fixes are worth reporting: every fix while
+ * moving, one fix when a stop begins, heartbeats while stationary and an
+ * immediate motion-start fix. Attach it with QuectelEC200U::setReportFilter().
+ *
+ * Author: ESP32 Arduino Library
+ * Date: 2024
+ */
+
+#ifndef GNSS_FILTER_H
+#define GNSS_FILTER_H
+
+#include "QuectelEC200U.h"
+
+// Position Filter Statistics
+struct GNSSFilterStats {
+    uint32_t accepted;     // Fixes used as measurements
+    uint32_t rejected;     // Fixes rejected by the outlier gate
+    uint32_t resets;       // Filter re-initialisations (gap, jump or reset())
+};
+
+class GNSSKalmanFilter {
+private:
+    // One axis of the constant-velocity model (position, velocity)
+    struct Axis {
+        float p;           // Metres from origin
+        float v;           // Metres per second
+        float p00, p01, p11; // Covariance
+    };
+
+    Axis east;
+    Axis north;
+    bool initialized;
+    double originLat;
+    double originLon;
+    float metersPerDegLon;
+    unsigned long lastTime;
+
+    float uere;            // User equivalent range error in metres (sigma = hdop * uere)
+    float accelNoise;      // Process noise, m/s^2
+    float gateThreshold;   // Chi-square threshold, 2 DOF
+    float speedNoise;      // Velocity measurement sigma, m/s
+    unsigned long maxGapMs;
+    uint8_t maxRejects;
+    uint8_t consecutiveRejects;
+
+    GNSSFilterStats stats;
+
+    void initialize(const GNSSPosition& position, unsigned long timestampMs);
+    void predict(Axis& axis, float dt);
+    void updatePosition(Axis& axis, float z, float r);
+    void updateVelocity(Axis& axis, float z, float r);
+
+public:
+    /**
+     * Create a filter
+     * @param uereMeters Range error per unit of HDOP in metres (default 5.0)
+     * @param accelNoiseMps2 Expected acceleration noise in m/s^2 (default 1.0)
+     * @param gateChi2 Outlier gate on the squared Mahalanobis distance
+     *                 (default 13.8 = 99.9% for 2 DOF)
+     */
+    GNSSKalmanFilter(float uereMeters = 5.0, float accelNoiseMps2 = 1.0, float gateChi2 = 13.8);
+
+    /**
+     * Filter one fix in place
+     *
+     * On acceptance latitude/longitude are replaced by the filtered estimate.
+     * On rejection they are replaced by the predicted position, so downstream
+     * consumers never see the outlier. Whenever the coordinates are replaced,
+     * latitudeStr/longitudeStr are cleared rather than left holding the raw
+     * modem values; format latitude/longitude if text is needed.
+     *
+     * @param position Fix to filter (must be valid)
+     * @param timestampMs Reception time in ms (millis())
+     * @return true if the fix was accepted, false if rejected as an outlier
+     */
+    bool update(GNSSPosition& position, unsigned long timestampMs);
+
+    /**
+     * Drop the current state; the next fix re-initialises the filter
+     */
+    void reset();
+
+    /**
+     * Set the velocity measurement noise used with speedKmh/courseOverGround
+     * @param sigmaMps Standard deviation in m/s (default 0.5)
+     */
+    void setSpeedNoise(float sigmaMps) { speedNoise = sigmaMps; }
+
+    /**
+     * Set when the filter gives up on its state
+     * @param maxGapMs Re-initialise if fixes are further apart than this (default 30000)
+     * @param maxRejects Re-initialise after this many consecutive rejections (default 5)
+     */
+    void setResetPolicy(unsigned long maxGapMs, uint8_t maxRejects) {
+        this->maxGapMs = maxGapMs;
+        this->maxRejects = maxRejects;
+    }
+
+    bool isInitialized() const { return initialized; }
+    const GNSSFilterStats& getStats() const { return stats; }
+
+    /**
+     * Get the filtered velocity
+     * @param speedKmh Reference to store speed in km/h
+     * @param courseDeg Reference to store course over ground in degrees
+     */
+    void getVelocity(float& speedKmh, float& courseDeg) const;
+};
+
+// Report Reason
+enum GNSSReportReason {
+    GNSS_REPORT_NONE = 0,          // Suppressed (stationary, no heartbeat due)
+    GNSS_REPORT_MOVING = 1,        // Fix while moving
+    GNSS_REPORT_STOP = 2,          // First fix of a stop
+    GNSS_REPORT_HEARTBEAT = 3,     // Periodic fix while stationary
+    GNSS_REPORT_MOTION_START = 4   // First fix after leaving a stop
+};
+
+// Report Filter Statistics
+struct GNSSReportStats {
+    uint32_t reported;
+    uint32_t suppressed;
+    uint32_t stops;
+};
+
+typedef void (*GNSSReportCallback)(const GNSSPosition& position, GNSSReportReason reason, void* context);
+
+class GNSSReportFilter {
+private:
+    bool stationary;
+    bool candidate;        // Slow fixes seen, stop not yet confirmed
+    double anchorLat;
+    double anchorLon;
+    float anchorMetersPerDegLon;
+    unsigned long candidateSince;
+    unsigned long lastReportTime;
+    GNSSReportReason lastReason;
+
+    float stopSpeedKmh;
+    float driftRadius;
+    float uere;
+    unsigned long stopDelayMs;
+    unsigned long heartbeatMs;
+    GNSSReportCallback callback;
+    void* callbackContext;
+    GNSSReportStats stats;
+
+    void setAnchor(const GNSSPosition& position);
+    bool beyondDrift(const GNSSPosition& position) const;
+    GNSSReportReason report(const GNSSPosition& position, GNSSReportReason reason, unsigned long timestampMs);
+
+public:
+    /**
+     * Create a report filter
+     * @param stopSpeedKmh Speed below which a fix counts as stationary (default 3)
+     * @param driftRadiusMeters Position drift tolerated while stationary, widened
+     *                          by the fix's HDOP (default 25)
+     * @param stopDelayMs Time slow fixes must stay within the drift radius before
+     *                    a stop is reported (default 30000)
+     * @param heartbeatMs Interval between heartbeat fixes while stationary (default 300000)
+     */
+    GNSSReportFilter(float stopSpeedKmh = 3.0, float driftRadiusMeters = 25.0,
+                     unsigned long stopDelayMs = 30000, unsigned long heartbeatMs = 300000);
+
+    /**
+     * Classify one fix
+     * @param position Fix to classify (ignored if not valid)
+     * @param timestampMs Reception time in ms (millis())
+     * @return Why the fix should be reported, or GNSS_REPORT_NONE to drop it
+     */
+    GNSSReportReason update(const GNSSPosition& position, unsigned long timestampMs);
+
+    /**
+     * Forget the stop state; the next fix is reported as moving
+     */
+    void reset();
+
+    /**
+     * Set the report callback
+     * @param cb Function called for every fix that should be reported
+     * @param context User pointer passed to the callback
+     */
+    void setCallback(GNSSReportCallback cb, void* context = nullptr) {
+        callback = cb;
+        callbackContext = context;
+    }
+
+    void setHeartbeat(unsigned long ms) { heartbeatMs = ms; }
+
+    /**
+     * Set the HDOP scaling of the drift radius
+     * @param uereMeters Metres added per unit of HDOP, times two (default 5.0)
+     */
+    void setUere(float uereMeters) { uere = uereMeters; }
+
+    bool isStationary() const { return stationary; }
+    GNSSReportReason getLastReason() const { return lastReason; }
+    const GNSSReportStats& getStats() const { return stats; }
+};
+
+#endif // GNSS_FILTER_H
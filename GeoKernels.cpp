@@ -0,0 +1,128 @@
+/**
+ * GeoKernels.cpp - Batch geodesic kernels for GNSS track buffers
+ *
+ * Author: ESP32 Arduino Library
+ * Date: 2024
+ */
+
+#include "GeoKernels.h"
+
+#define GEO_RESTRICT __restrict__
+
+// Metres per degree of arc on the mean sphere
+#define METERS_PER_DEG_F ((float)(GEO_EARTH_RADIUS_M * DEG_TO_RAD))
+
+double geoHaversineDistance(double lat1, double lon1, double lat2, double lon2) {
+    double phi1 = lat1 * DEG_TO_RAD;
+    double phi2 = lat2 * DEG_TO_RAD;
+    double sinHalfLat = sin((phi2 - phi1) * 0.5);
+    double sinHalfLon = sin((lon2 - lon1) * DEG_TO_RAD * 0.5);
+    double a = sinHalfLat * sinHalfLat + cos(phi1) * cos(phi2) * sinHalfLon * sinHalfLon;
+    return 2.0 * GEO_EARTH_RADIUS_M * asin(sqrt(a < 1.0 ? a : 1.0));
+}
+
+double geoInitialBearing(double lat1, double lon1, double lat2, double lon2) {
+    double phi1 = lat1 * DEG_TO_RAD;
+    double phi2 = lat2 * DEG_TO_RAD;
+    double dLon = (lon2 - lon1) * DEG_TO_RAD;
+    double y = sin(dLon) * cos(phi2);
+    double x = cos(phi1) * sin(phi2) - sin(phi1) * cos(phi2) * cos(dLon);
+    double bearing = atan2(y, x) * RAD_TO_DEG;
+    return (bearing < 0) ? bearing + 360.0 : bearing;
+}
+
+void geoPrecomputeCosines(const double* GEO_RESTRICT latitudes, float* GEO_RESTRICT cosLat,
+                          size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        cosLat[i] = cosf((float)latitudes[i] * (float)DEG_TO_RAD);
+    }
+}
+
+// Longitude difference wrapped to [-180, 180] without branches; wrapped in
+// double because a float near 360 keeps only ~2 m of resolution
+static inline float wrapLongitude(double dLon) {
+    return (float)(dLon - 360.0 * (double)(dLon > 180.0) + 360.0 * (double)(dLon < -180.0));
+}
+
+void geoSegmentDistances(const double* GEO_RESTRICT latitudes, const double* GEO_RESTRICT longitudes,
+                         const float* GEO_RESTRICT cosLat, float* GEO_RESTRICT distances,
+                         size_t count) {
+    if (count < 2) {
+        return;
+    }
+    size_t segments = count - 1;
+
+    // Equirectangular: cos of the mid-latitude ~ mean of the endpoint cosines
+    for (size_t i = 0; i < segments; i++) {
+        float dLat = (float)(latitudes[i + 1] - latitudes[i]);
+        float dLon = wrapLongitude(longitudes[i + 1] - longitudes[i]);
+        float x = dLon * 0.5f * (cosLat[i] + cosLat[i + 1]);
+        distances[i] = METERS_PER_DEG_F * sqrtf(x * x + dLat * dLat);
+    }
+
+    // Rare long segments: exact great-circle distance
+    for (size_t i = 0; i < segments; i++) {
+        if (distances[i] > GEO_EQUIRECT_MAX_M) {
+            distances[i] = (float)geoHaversineDistance(latitudes[i], longitudes[i],
+                                                       latitudes[i + 1], longitudes[i + 1]);
+        }
+    }
+}
+
+void geoSegmentBearings(const double* GEO_RESTRICT latitudes, const double* GEO_RESTRICT longitudes,
+                        const float* GEO_RESTRICT cosLat, float* GEO_RESTRICT bearings,
+                        size_t count) {
+    if (count < 2) {
+        return;
+    }
+    size_t segments = count - 1;
+    const float maxDeg = GEO_EQUIRECT_MAX_M / METERS_PER_DEG_F;
+
+    for (size_t i = 0; i < segments; i++) {
+        float dLat = (float)(latitudes[i + 1] - latitudes[i]);
+        float dLon = wrapLongitude(longitudes[i + 1] - longitudes[i]);
+        float x = dLon * 0.5f * (cosLat[i] + cosLat[i + 1]);
+        float bearing = atan2f(x, dLat) * (float)RAD_TO_DEG;
+        bearings[i] = bearing + 360.0f * (float)(bearing < 0.0f);
+    }
+
+    for (size_t i = 0; i < segments; i++) {
+        float dLat = (float)(latitudes[i + 1] - latitudes[i]);
+        float dLon = wrapLongitude(longitudes[i + 1] - longitudes[i]);
+        if (fabsf(dLat) > maxDeg || fabsf(dLon * cosLat[i]) > maxDeg) {
+            bearings[i] = (float)geoInitialBearing(latitudes[i], longitudes[i],
+                                                   latitudes[i + 1], longitudes[i + 1]);
+        }
+    }
+}
+
+double geoOdometer(const float* GEO_RESTRICT distances, size_t segments,
+                   float* GEO_RESTRICT cumulative) {
+    // Double accumulator: float loses metres after a few thousand km
+    double total = 0;
+    if (cumulative == nullptr) {
+        for (size_t i = 0; i < segments; i++) {
+            total += distances[i];
+        }
+        return total;
+    }
+    for (size_t i = 0; i < segments; i++) {
+        total += distances[i];
+        cumulative[i] = (float)total;
+    }
+    return total;
+}
+
+size_t geoValidateSpeeds(const float* GEO_RESTRICT distances,
+                         const unsigned long* GEO_RESTRICT timestampsMs,
+                         size_t segments, float maxSpeedKmh, uint8_t* GEO_RESTRICT valid) {
+    // d / dt <= vmax rewritten as d * 3600 <= vmax * dtMs (no division, dt = 0 handled)
+    size_t invalid = 0;
+    for (size_t i = 0; i < segments; i++) {
+        float dtMs = (float)(timestampsMs[i + 1] - timestampsMs[i]);
+        uint8_t ok = (uint8_t)(distances[i] * 3600.0f <= maxSpeedKmh * dtMs);
+        valid[i] = ok;
+        invalid += 1 - ok;
+    }
+    return invalid;
+}
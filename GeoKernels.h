@@ -0,0 +1,90 @@
+/**
+ * GeoKernels.h - Batch geodesic kernels for GNSS track buffers
+ *
+ * Distance, bearing, odometer and speed validation over a track stored as
+ * separate latitude/longitude arrays (structure of arrays). Each point's
+ * cos(latitude) is computed once and shared by its two segments, and
+ * segment math uses the float equirectangular approximation; the rare long
+ * segments where that loses accuracy are recomputed with haversine.
+ *
+ * The inner loops are branch-free over plain arrays so host compilers can
+ * auto-vectorise them.
+ *
+ * Author: ESP32 Arduino Library
+ * Date: 2024
+ */
+
+#ifndef GEO_KERNELS_H
+#define GEO_KERNELS_H
+
+#include <Arduino.h>
+
+// Mean Earth radius in metres
+#define GEO_EARTH_RADIUS_M 6371008.8
+
+// Segments longer than this are recomputed with haversine
+#ifndef GEO_EQUIRECT_MAX_M
+#define GEO_EQUIRECT_MAX_M 20000.0f
+#endif
+
+/**
+ * Great-circle distance (haversine, double precision)
+ * @return Distance in metres
+ */
+double geoHaversineDistance(double lat1, double lon1, double lat2, double lon2);
+
+/**
+ * Initial great-circle bearing from point 1 to point 2
+ * @return Bearing in degrees (0-360, 0 = north)
+ */
+double geoInitialBearing(double lat1, double lon1, double lat2, double lon2);
+
+/**
+ * Compute cos(latitude) for every point
+ * @param latitudes Latitudes in decimal degrees
+ * @param cosLat Output array (count entries)
+ * @param count Number of points
+ */
+void geoPrecomputeCosines(const double* latitudes, float* cosLat, size_t count);
+
+/**
+ * Distance of every segment between consecutive points
+ * @param latitudes Latitudes in decimal degrees
+ * @param longitudes Longitudes in decimal degrees
+ * @param cosLat Output of geoPrecomputeCosines()
+ * @param distances Output array (count - 1 entries), metres
+ * @param count Number of points
+ */
+void geoSegmentDistances(const double* latitudes, const double* longitudes,
+                         const float* cosLat, float* distances, size_t count);
+
+/**
+ * Bearing of every segment between consecutive points
+ * @param bearings Output array (count - 1 entries), degrees 0-360
+ * @see geoSegmentDistances() for the other parameters
+ */
+void geoSegmentBearings(const double* latitudes, const double* longitudes,
+                        const float* cosLat, float* bearings, size_t count);
+
+/**
+ * Sum segment distances
+ * @param distances Segment distances in metres
+ * @param segments Number of segments
+ * @param cumulative Optional output (segments entries): odometer at the end of each segment
+ * @return Total distance in metres
+ */
+double geoOdometer(const float* distances, size_t segments, float* cumulative = nullptr);
+
+/**
+ * Flag segments whose implied speed is implausible
+ * @param distances Segment distances in metres
+ * @param timestampsMs Point timestamps in ms (segments + 1 entries)
+ * @param segments Number of segments
+ * @param maxSpeedKmh Highest plausible speed
+ * @param valid Output array (segments entries): 1 if plausible, 0 otherwise
+ * @return Number of implausible segments
+ */
+size_t geoValidateSpeeds(const float* distances, const unsigned long* timestampsMs,
+                         size_t segments, float maxSpeedKmh, uint8_t* valid);
+
+#endif // GEO_KERNELS_H
@@ -0,0 +1,346 @@
+/**
+ * Geofence.cpp - Geofence engine for QuectelEC200U GNSS fixes
+ *
+ * Author: ESP32 Arduino Library
+ * Date: 2024
+ */
+
+#include "Geofence.h"
+#include <stdlib.h>
+
+#define MICRODEG_PER_DEG 1000000.0
+#define METERS_PER_MICRODEG_LAT 0.11131949
+
+// Fence flags
+#define FENCE_INSIDE 0x01
+#define FENCE_HIT 0x02
+#define FENCE_DWELL_SENT 0x04
+
+#define GRID_CELLS (GEOFENCE_GRID_DIM * GEOFENCE_GRID_DIM)
+
+static int32_t toMicrodegrees(double degrees) {
+    return (int32_t)lround(degrees * MICRODEG_PER_DEG);
+}
+
+GeofenceEngine::GeofenceEngine() {
+    fences = nullptr;
+    vertexLat = nullptr;
+    vertexLon = nullptr;
+    cellItems = nullptr;
+    activeIds = nullptr;
+    maxFences = 0;
+    maxVertices = 0;
+    fenceCount = 0;
+    vertexCount = 0;
+    activeCount = 0;
+    indexValid = false;
+    callback = nullptr;
+    callbackContext = nullptr;
+    testsPerformed = 0;
+}
+
+GeofenceEngine::~GeofenceEngine() {
+    end();
+}
+
+bool GeofenceEngine::begin(uint16_t maxFences, uint16_t maxVertices) {
+    end();
+
+    fences = (Fence*)malloc(sizeof(Fence) * maxFences);
+    activeIds = (uint16_t*)malloc(sizeof(uint16_t) * maxFences);
+    if (maxVertices > 0) {
+        vertexLat = (int32_t*)malloc(sizeof(int32_t) * maxVertices);
+        vertexLon = (int32_t*)malloc(sizeof(int32_t) * maxVertices);
+    }
+    if (fences == nullptr || activeIds == nullptr ||
+        (maxVertices > 0 && (vertexLat == nullptr || vertexLon == nullptr))) {
+        QLOG_ERROR("Geofence: out of memory");
+        end();
+        return false;
+    }
+
+    this->maxFences = maxFences;
+    this->maxVertices = maxVertices;
+    clear();
+    return true;
+}
+
+void GeofenceEngine::end() {
+    free(fences);
+    free(vertexLat);
+    free(vertexLon);
+    free(cellItems);
+    free(activeIds);
+    fences = nullptr;
+    vertexLat = nullptr;
+    vertexLon = nullptr;
+    cellItems = nullptr;
+    activeIds = nullptr;
+    maxFences = 0;
+    maxVertices = 0;
+    fenceCount = 0;
+    vertexCount = 0;
+    activeCount = 0;
+    indexValid = false;
+}
+
+void GeofenceEngine::clear() {
+    fenceCount = 0;
+    vertexCount = 0;
+    activeCount = 0;
+    indexValid = false;
+}
+
+int GeofenceEngine::addCircle(double latitude, double longitude, float radiusMeters,
+                              unsigned long dwellMs) {
+    if (fenceCount >= maxFences) {
+        return -1;
+    }
+
+    Fence& fence = fences[fenceCount];
+    int32_t radius = (int32_t)(radiusMeters / METERS_PER_MICRODEG_LAT) + 1;
+    double cosLat = cos(latitude * DEG_TO_RAD);
+    int32_t radiusLon = (cosLat > 0.01) ? (int32_t)(radius / cosLat) + 1 : 180000000;
+
+    fence.type = GEOFENCE_CIRCLE;
+    fence.centerLat = toMicrodegrees(latitude);
+    fence.centerLon = toMicrodegrees(longitude);
+    fence.radiusSq = (int64_t)radius * radius;
+    fence.cosLatQ15 = (int32_t)(cosLat * 32768.0);
+    fence.minLat = fence.centerLat - radius;
+    fence.maxLat = fence.centerLat + radius;
+    fence.minLon = fence.centerLon - radiusLon;
+    fence.maxLon = fence.centerLon + radiusLon;
+    fence.firstVertex = 0;
+    fence.vertexCount = 0;
+    fence.flags = 0;
+    fence.dwellMs = dwellMs;
+    fence.enterTime = 0;
+
+    indexValid = false;
+    return fenceCount++;
+}
+
+int GeofenceEngine::addPolygon(const double* latitudes, const double* longitudes, uint16_t count,
+                               unsigned long dwellMs) {
+    if (fenceCount >= maxFences || count < 3 || (uint32_t)vertexCount + count > maxVertices) {
+        return -1;
+    }
+
+    Fence& fence = fences[fenceCount];
+    fence.type = GEOFENCE_POLYGON;
+    fence.firstVertex = vertexCount;
+    fence.vertexCount = count;
+    fence.minLat = INT32_MAX;
+    fence.minLon = INT32_MAX;
+    fence.maxLat = INT32_MIN;
+    fence.maxLon = INT32_MIN;
+
+    for (uint16_t i = 0; i < count; i++) {
+        int32_t lat = toMicrodegrees(latitudes[i]);
+        int32_t lon = toMicrodegrees(longitudes[i]);
+        vertexLat[vertexCount + i] = lat;
+        vertexLon[vertexCount + i] = lon;
+        if (lat < fence.minLat) fence.minLat = lat;
+        if (lat > fence.maxLat) fence.maxLat = lat;
+        if (lon < fence.minLon) fence.minLon = lon;
+        if (lon > fence.maxLon) fence.maxLon = lon;
+    }
+    vertexCount += count;
+
+    fence.centerLat = 0;
+    fence.centerLon = 0;
+    fence.radiusSq = 0;
+    fence.cosLatQ15 = 0;
+    fence.flags = 0;
+    fence.dwellMs = dwellMs;
+    fence.enterTime = 0;
+
+    indexValid = false;
+    return fenceCount++;
+}
+
+bool GeofenceEngine::buildIndex() {
+    free(cellItems);
+    cellItems = nullptr;
+    indexValid = false;
+
+    if (fenceCount == 0) {
+        return true;
+    }
+
+    // Grid covers the union of all bounding boxes
+    int32_t minLat = INT32_MAX, minLon = INT32_MAX;
+    int32_t maxLat = INT32_MIN, maxLon = INT32_MIN;
+    for (uint16_t i = 0; i < fenceCount; i++) {
+        if (fences[i].minLat < minLat) minLat = fences[i].minLat;
+        if (fences[i].minLon < minLon) minLon = fences[i].minLon;
+        if (fences[i].maxLat > maxLat) maxLat = fences[i].maxLat;
+        if (fences[i].maxLon > maxLon) maxLon = fences[i].maxLon;
+    }
+    gridMinLat = minLat;
+    gridMinLon = minLon;
+    cellHeight = (int32_t)(((int64_t)maxLat - minLat) / GEOFENCE_GRID_DIM) + 1;
+    cellWidth = (int32_t)(((int64_t)maxLon - minLon) / GEOFENCE_GRID_DIM) + 1;
+
+    // Pass 1: count references per cell
+    memset(cellStart, 0, sizeof(cellStart));
+    for (uint16_t i = 0; i < fenceCount; i++) {
+        int r0 = (fences[i].minLat - gridMinLat) / cellHeight;
+        int r1 = (fences[i].maxLat - gridMinLat) / cellHeight;
+        int c0 = (fences[i].minLon - gridMinLon) / cellWidth;
+        int c1 = (fences[i].maxLon - gridMinLon) / cellWidth;
+        for (int r = r0; r <= r1; r++) {
+            for (int c = c0; c <= c1; c++) {
+                cellStart[r * GEOFENCE_GRID_DIM + c + 1]++;
+            }
+        }
+    }
+    for (int cell = 0; cell < GRID_CELLS; cell++) {
+        cellStart[cell + 1] += cellStart[cell];
+    }
+
+    cellItems = (uint16_t*)malloc(sizeof(uint16_t) * (cellStart[GRID_CELLS] + 1));
+    if (cellItems == nullptr) {
+        QLOG_ERROR("Geofence: out of memory building index");
+        return false;
+    }
+
+    // Pass 2: fill, using cellStart[cell] as the write cursor and restoring it after
+    for (uint16_t i = 0; i < fenceCount; i++) {
+        int r0 = (fences[i].minLat - gridMinLat) / cellHeight;
+        int r1 = (fences[i].maxLat - gridMinLat) / cellHeight;
+        int c0 = (fences[i].minLon - gridMinLon) / cellWidth;
+        int c1 = (fences[i].maxLon - gridMinLon) / cellWidth;
+        for (int r = r0; r <= r1; r++) {
+            for (int c = c0; c <= c1; c++) {
+                cellItems[cellStart[r * GEOFENCE_GRID_DIM + c]++] = i;
+            }
+        }
+    }
+    for (int cell = GRID_CELLS; cell > 0; cell--) {
+        cellStart[cell] = cellStart[cell - 1];
+    }
+    cellStart[0] = 0;
+
+    indexValid = true;
+    return true;
+}
+
+int GeofenceEngine::cellOf(int32_t lat, int32_t lon) const {
+    if (lat < gridMinLat || lon < gridMinLon) {
+        return -1;
+    }
+    int32_t row = (lat - gridMinLat) / cellHeight;
+    int32_t col = (lon - gridMinLon) / cellWidth;
+    if (row >= GEOFENCE_GRID_DIM || col >= GEOFENCE_GRID_DIM) {
+        return -1;
+    }
+    return row * GEOFENCE_GRID_DIM + col;
+}
+
+bool GeofenceEngine::containsPolygon(const Fence& fence, int32_t lat, int32_t lon) const {
+    // Crossing-number test relative to the fix, 64-bit cross products
+    bool inside = false;
+    const int32_t* vLat = vertexLat + fence.firstVertex;
+    const int32_t* vLon = vertexLon + fence.firstVertex;
+    uint16_t j = fence.vertexCount - 1;
+
+    for (uint16_t i = 0; i < fence.vertexCount; j = i++) {
+        int32_t yi = vLat[i] - lat;
+        int32_t yj = vLat[j] - lat;
+        if ((yi > 0) != (yj > 0)) {
+            int64_t xi = vLon[i] - lon;
+            int64_t xj = vLon[j] - lon;
+            // Edge crosses the horizontal ray to the east of the fix?
+            int64_t cross = xi * yj - xj * yi;
+            if ((yj > yi) ? (cross > 0) : (cross < 0)) {
+                inside = !inside;
+            }
+        }
+    }
+    return inside;
+}
+
+bool GeofenceEngine::contains(const Fence& fence, int32_t lat, int32_t lon) const {
+    if (lat < fence.minLat || lat > fence.maxLat || lon < fence.minLon || lon > fence.maxLon) {
+        return false;
+    }
+    if (fence.type == GEOFENCE_CIRCLE) {
+        int64_t dLat = lat - fence.centerLat;
+        int64_t dLon = ((int64_t)(lon - fence.centerLon) * fence.cosLatQ15) >> 15;
+        return dLat * dLat + dLon * dLon <= fence.radiusSq;
+    }
+    return containsPolygon(fence, lat, lon);
+}
+
+void GeofenceEngine::emit(uint16_t fenceId, GeofenceEventType type, unsigned long timestamp) {
+    if (callback != nullptr) {
+        GeofenceEvent event;
+        event.fenceId = fenceId;
+        event.type = type;
+        event.timestamp = timestamp;
+        callback(event, callbackContext);
+    }
+}
+
+uint16_t GeofenceEngine::update(double latitude, double longitude, unsigned long timestampMs) {
+    testsPerformed = 0;
+    if (!indexValid && !buildIndex()) {
+        return 0;
+    }
+
+    uint16_t events = 0;
+    int32_t lat = toMicrodegrees(latitude);
+    int32_t lon = toMicrodegrees(longitude);
+
+    // Test only the fences indexed in the fix's cell
+    int cell = (fenceCount > 0) ? cellOf(lat, lon) : -1;
+    if (cell >= 0) {
+        for (uint32_t k = cellStart[cell]; k < cellStart[cell + 1]; k++) {
+            uint16_t id = cellItems[k];
+            Fence& fence = fences[id];
+            testsPerformed++;
+            if (!contains(fence, lat, lon)) {
+                continue;
+            }
+            fence.flags |= FENCE_HIT;
+            if (!(fence.flags & FENCE_INSIDE)) {
+                fence.flags |= FENCE_INSIDE;
+                fence.flags &= ~FENCE_DWELL_SENT;
+                fence.enterTime = timestampMs;
+                activeIds[activeCount++] = id;
+                emit(id, GEOFENCE_EVENT_ENTER, timestampMs);
+                events++;
+            }
+        }
+    }
+
+    // Fences that were not hit this time have been left
+    uint16_t i = 0;
+    while (i < activeCount) {
+        uint16_t id = activeIds[i];
+        Fence& fence = fences[id];
+        if (!(fence.flags & FENCE_HIT)) {
+            fence.flags &= ~(FENCE_INSIDE | FENCE_DWELL_SENT);
+            activeIds[i] = activeIds[--activeCount];
+            emit(id, GEOFENCE_EVENT_EXIT, timestampMs);
+            events++;
+            continue;
+        }
+        fence.flags &= ~FENCE_HIT;
+        if (fence.dwellMs > 0 && !(fence.flags & FENCE_DWELL_SENT) &&
+            timestampMs - fence.enterTime >= fence.dwellMs) {
+            fence.flags |= FENCE_DWELL_SENT;
+            emit(id, GEOFENCE_EVENT_DWELL, timestampMs);
+            events++;
+        }
+        i++;
+    }
+
+    return events;
+}
+
+bool GeofenceEngine::isInside(uint16_t fenceId) const {
+    return fenceId < fenceCount && (fences[fenceId].flags & FENCE_INSIDE);
+}
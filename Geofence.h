@@ -0,0 +1,175 @@
+/**
+ * Geofence.h - Geofence engine for QuectelEC200U GNSS fixes
+ *
+ * Checks each fix against circle and polygon geofences and generates
+ * enter/exit/dwell events. Fence bounding boxes are indexed in a uniform
+ * grid, so only fences overlapping the fix's grid cell are tested.
+ * Containment tests use fixed-point microdegrees and 64-bit integer math.
+ *
+ * Limitations: fences must not cross the antimeridian.
+ *
+ * Author: ESP32 Arduino Library
+ * Date: 2024
+ */
+
+#ifndef GEOFENCE_H
+#define GEOFENCE_H
+
+#include "QuectelEC200U.h"
+
+// Grid cells per axis over the bounding box of all fences
+#ifndef GEOFENCE_GRID_DIM
+#define GEOFENCE_GRID_DIM 32
+#endif
+
+// Geofence Shape
+enum GeofenceType {
+    GEOFENCE_CIRCLE = 0,
+    GEOFENCE_POLYGON = 1
+};
+
+// Geofence Event Type
+enum GeofenceEventType {
+    GEOFENCE_EVENT_ENTER = 0,
+    GEOFENCE_EVENT_EXIT = 1,
+    GEOFENCE_EVENT_DWELL = 2
+};
+
+// Geofence Event
+struct GeofenceEvent {
+    uint16_t fenceId;
+    GeofenceEventType type;
+    unsigned long timestamp;  // Timestamp passed to update()
+};
+
+typedef void (*GeofenceCallback)(const GeofenceEvent& event, void* context);
+
+class GeofenceEngine {
+private:
+    struct Fence {
+        int32_t minLat, minLon, maxLat, maxLon;  // Bounding box, microdegrees
+        int32_t centerLat, centerLon;            // Circle centre, microdegrees
+        int64_t radiusSq;                        // Circle radius^2, microdegrees of latitude
+        int32_t cosLatQ15;                       // cos(centre latitude) in Q15
+        uint16_t firstVertex;
+        uint16_t vertexCount;
+        uint8_t type;
+        uint8_t flags;
+        unsigned long dwellMs;
+        unsigned long enterTime;
+    };
+
+    Fence* fences;
+    int32_t* vertexLat;
+    int32_t* vertexLon;
+    uint16_t maxFences;
+    uint16_t maxVertices;
+    uint16_t fenceCount;
+    uint16_t vertexCount;
+
+    // Grid index (compressed rows: cellStart[c]..cellStart[c+1] in cellItems)
+    uint32_t cellStart[GEOFENCE_GRID_DIM * GEOFENCE_GRID_DIM + 1];
+    uint16_t* cellItems;
+    int32_t gridMinLat, gridMinLon;
+    int32_t cellHeight, cellWidth;
+    bool indexValid;
+
+    // Fences currently containing the last fix
+    uint16_t* activeIds;
+    uint16_t activeCount;
+
+    GeofenceCallback callback;
+    void* callbackContext;
+    uint32_t testsPerformed;
+
+    bool contains(const Fence& fence, int32_t lat, int32_t lon) const;
+    bool containsPolygon(const Fence& fence, int32_t lat, int32_t lon) const;
+    int cellOf(int32_t lat, int32_t lon) const;
+    void emit(uint16_t fenceId, GeofenceEventType type, unsigned long timestamp);
+
+public:
+    GeofenceEngine();
+    ~GeofenceEngine();
+
+    /**
+     * Allocate fence storage
+     * @param maxFences Maximum number of fences
+     * @param maxVertices Total polygon vertices shared by all fences
+     * @return true if successful, false if out of memory
+     */
+    bool begin(uint16_t maxFences, uint16_t maxVertices);
+
+    /**
+     * Release all storage
+     */
+    void end();
+
+    /**
+     * Add a circular fence
+     * @param latitude Centre latitude in decimal degrees
+     * @param longitude Centre longitude in decimal degrees
+     * @param radiusMeters Radius in metres
+     * @param dwellMs Dwell time that raises a DWELL event (0 = no dwell event)
+     * @return Fence ID, or -1 if full
+     */
+    int addCircle(double latitude, double longitude, float radiusMeters, unsigned long dwellMs = 0);
+
+    /**
+     * Add a polygon fence
+     * @param latitudes Vertex latitudes in decimal degrees
+     * @param longitudes Vertex longitudes in decimal degrees
+     * @param count Number of vertices (>= 3, polygon is closed implicitly)
+     * @param dwellMs Dwell time that raises a DWELL event (0 = no dwell event)
+     * @return Fence ID, or -1 if full
+     */
+    int addPolygon(const double* latitudes, const double* longitudes, uint16_t count,
+                   unsigned long dwellMs = 0);
+
+    /**
+     * Remove all fences and reset inside/outside state
+     */
+    void clear();
+
+    /**
+     * Build the grid index; called automatically by update() after fences change
+     * @return true if successful, false if out of memory
+     */
+    bool buildIndex();
+
+    /**
+     * Process a fix and generate events through the callback
+     * @param latitude Latitude in decimal degrees
+     * @param longitude Longitude in decimal degrees
+     * @param timestampMs Fix time in ms (used for dwell and event timestamps)
+     * @return Number of events generated
+     */
+    uint16_t update(double latitude, double longitude, unsigned long timestampMs);
+
+    /**
+     * Process a fix from the modem (ignored if not valid)
+     */
+    uint16_t update(const GNSSPosition& position, unsigned long timestampMs) {
+        return position.valid ? update(position.latitude, position.longitude, timestampMs) : 0;
+    }
+
+    /**
+     * Set the event callback
+     * @param cb Function called for each enter/exit/dwell event
+     * @param context User pointer passed to the callback
+     */
+    void setCallback(GeofenceCallback cb, void* context = nullptr) {
+        callback = cb;
+        callbackContext = context;
+    }
+
+    bool isInside(uint16_t fenceId) const;
+    uint16_t getFenceCount() const { return fenceCount; }
+    uint16_t getInsideCount() const { return activeCount; }
+
+    /**
+     * Get the number of containment tests run by the last update()
+     */
+    uint32_t getLastTestCount() const { return testsPerformed; }
+};
+
+#endif // GEOFENCE_H
@@ -0,0 +1,332 @@
+/**
+ * NMEAParser.cpp - Allocation-free NMEA sentence parser for QuectelEC200U
+ *
+ * Author: ESP32 Arduino Library
+ * Date: 2024
+ */
+
+#include "NMEAParser.h"
+
+#define NMEA_MAX_FIELDS 24
+
+// Split "$xxYYY,a,b,...*hh" into field start pointers; field 0 is "$xxYYY"
+static uint8_t splitFields(const char* sentence, size_t length, const char** fields) {
+    uint8_t count = 0;
+    fields[count++] = sentence;
+    for (size_t i = 0; i < length && count < NMEA_MAX_FIELDS; i++) {
+        if (sentence[i] == '*') {
+            break;
+        }
+        if (sentence[i] == ',') {
+            fields[count++] = sentence + i + 1;
+        }
+    }
+    return count;
+}
+
+static bool fieldEmpty(const char* field) {
+    return *field == ',' || *field == '*' || *field == '\r' || *field == '\0';
+}
+
+static uint16_t parseUInt(const char* field) {
+    uint16_t value = 0;
+    while (*field >= '0' && *field <= '9') {
+        value = value * 10 + (*field - '0');
+        field++;
+    }
+    return value;
+}
+
+static float parseDecimal(const char* field) {
+    float value = 0;
+    while (*field >= '0' && *field <= '9') {
+        value = value * 10 + (*field - '0');
+        field++;
+    }
+    if (*field == '.') {
+        float scale = 0.1f;
+        field++;
+        while (*field >= '0' && *field <= '9') {
+            value += (*field - '0') * scale;
+            scale *= 0.1f;
+            field++;
+        }
+    }
+    return value;
+}
+
+// NMEA "ddmm.mmmm"/"dddmm.mmmm" plus hemisphere -> signed decimal degrees
+static double parseCoordinate(const char* field, const char* hemisphere) {
+    double raw = strtod(field, nullptr);
+    int degrees = (int)(raw / 100);
+    double value = degrees + (raw - degrees * 100) / 60.0;
+    return (*hemisphere == 'S' || *hemisphere == 'W') ? -value : value;
+}
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+NMEAParser::NMEAParser() {
+    reset();
+}
+
+void NMEAParser::reset() {
+    memset(&sky, 0, sizeof(sky));
+    memset(&fix, 0, sizeof(fix));
+}
+
+GNSSConstellation NMEAParser::constellationFromTalker(const char* talker) {
+    if (talker[0] == 'G' && talker[1] == 'P') return GNSS_CONSTELLATION_GPS;
+    if (talker[0] == 'G' && talker[1] == 'L') return GNSS_CONSTELLATION_GLONASS;
+    if (talker[0] == 'G' && talker[1] == 'B') return GNSS_CONSTELLATION_BEIDOU;
+    if (talker[0] == 'B' && talker[1] == 'D') return GNSS_CONSTELLATION_BEIDOU;
+    if (talker[0] == 'G' && talker[1] == 'A') return GNSS_CONSTELLATION_GALILEO;
+    return GNSS_CONSTELLATION_COUNT;
+}
+
+GNSSConstellation NMEAParser::constellationFromPrn(uint16_t prn) {
+    if (prn >= 1 && prn <= 64) return GNSS_CONSTELLATION_GPS;       // GPS + SBAS
+    if (prn >= 65 && prn <= 96) return GNSS_CONSTELLATION_GLONASS;
+    if ((prn >= 141 && prn <= 177) || (prn >= 201 && prn <= 263) || (prn >= 401 && prn <= 463)) {
+        return GNSS_CONSTELLATION_BEIDOU;
+    }
+    if (prn >= 301 && prn <= 336) return GNSS_CONSTELLATION_GALILEO;
+    return GNSS_CONSTELLATION_COUNT;
+}
+
+bool NMEAParser::parse(const char* sentence, size_t length) {
+    // Strip trailing CR/LF
+    while (length > 0 && (sentence[length - 1] == '\r' || sentence[length - 1] == '\n')) {
+        length--;
+    }
+    if (length < 7 || length > NMEA_MAX_SENTENCE || sentence[0] != '$') {
+        return false;
+    }
+
+    // The field parsers stop at the first non-digit; a terminated copy keeps
+    // them inside the sentence whatever follows it in the caller's buffer
+    char line[NMEA_MAX_SENTENCE + 1];
+    memcpy(line, sentence, length);
+    line[length] = '\0';
+    sentence = line;
+
+    // Verify checksum if present
+    const char* star = (const char*)memchr(sentence, '*', length);
+    if (star != nullptr) {
+        size_t starIdx = star - sentence;
+        if (starIdx + 3 > length) {
+            return false;
+        }
+        uint8_t checksum = 0;
+        for (size_t i = 1; i < starIdx; i++) {
+            checksum ^= (uint8_t)sentence[i];
+        }
+        int hi = hexValue(star[1]);
+        int lo = hexValue(star[2]);
+        if (hi < 0 || lo < 0 || checksum != (uint8_t)((hi << 4) | lo)) {
+            return false;
+        }
+    }
+
+    const char* type = sentence + 3;
+    if (memcmp(type, "GSV,", 4) == 0) {
+        return parseGSV(sentence, length);
+    }
+    if (memcmp(type, "GSA,", 4) == 0) {
+        return parseGSA(sentence, length);
+    }
+    if (memcmp(type, "RMC,", 4) == 0) {
+        return parseRMC(sentence, length);
+    }
+    if (memcmp(type, "GGA,", 4) == 0) {
+        return parseGGA(sentence, length);
+    }
+    return false;
+}
+
+// NMEA 4.1 signal ID of the L1 civil signal, indexed by GNSSConstellation
+static const uint8_t primarySignals[GNSS_CONSTELLATION_COUNT] = {
+    1,  // GPS L1 C/A
+    1,  // GLONASS L1 C/A
+    1,  // BeiDou B1I
+    7   // Galileo E1
+};
+
+void NMEAParser::markUsed(GNSSConstellationView& view) {
+    for (uint8_t i = 0; i < view.count; i++) {
+        bool used = false;
+        for (uint8_t k = 0; k < view.used && !used; k++) {
+            used = (view.satellites[i].prn == view.usedPrns[k]);
+        }
+        view.satellites[i].used = used;
+    }
+}
+
+bool NMEAParser::parseGSV(const char* sentence, size_t length) {
+    // $xxGSV,<msgs>,<msg>,<in view>,{<prn>,<elev>,<az>,<snr>}x1..4[,<signal>]*hh
+    const char* fields[NMEA_MAX_FIELDS];
+    uint8_t fieldCount = splitFields(sentence, length, fields);
+    if (fieldCount < 4) {
+        return false;
+    }
+
+    uint8_t blocks = (fieldCount - 4) / 4;
+    bool hasSignalId = ((fieldCount - 4) % 4) == 1;
+
+    GNSSConstellation constellation = constellationFromTalker(sentence + 1);
+    if (constellation == GNSS_CONSTELLATION_COUNT && blocks > 0) {
+        constellation = constellationFromPrn(parseUInt(fields[4]));
+    }
+    if (constellation == GNSS_CONSTELLATION_COUNT) {
+        return false;
+    }
+
+    GNSSConstellationView& view = sky.constellations[constellation];
+
+    // Other signal bands repeat the same satellites. Keep the primary signal,
+    // or the first one seen if the firmware never reports the primary.
+    uint8_t signalId = (hasSignalId && !fieldEmpty(fields[fieldCount - 1])) ? parseUInt(fields[fieldCount - 1]) : 0;
+    if (signalId != 0 && signalId != primarySignals[constellation] &&
+        view.signalId != 0 && view.signalId != signalId) {
+        return true;
+    }
+    view.signalId = signalId;
+    uint8_t totalMessages = parseUInt(fields[1]);
+    uint8_t messageNumber = parseUInt(fields[2]);
+    if (messageNumber == 1) {
+        view.count = 0;
+    }
+    view.inView = parseUInt(fields[3]);
+
+    for (uint8_t b = 0; b < blocks && view.count < NMEA_MAX_SATELLITES; b++) {
+        const char** f = fields + 4 + b * 4;
+        if (fieldEmpty(f[0])) {
+            continue;
+        }
+        GNSSSatellite& sat = view.satellites[view.count++];
+        sat.prn = parseUInt(f[0]);
+        sat.elevation = parseUInt(f[1]);
+        sat.azimuth = parseUInt(f[2]);
+        sat.snr = parseUInt(f[3]);  // Empty when not tracked -> 0
+        sat.used = false;
+        for (uint8_t k = 0; k < view.used; k++) {
+            if (view.usedPrns[k] == sat.prn) {
+                sat.used = true;
+                break;
+            }
+        }
+    }
+
+    if (messageNumber == totalMessages) {
+        view.updated = millis();
+    }
+    return true;
+}
+
+bool NMEAParser::parseGSA(const char* sentence, size_t length) {
+    // $xxGSA,<mode>,<fix>,<prn>x12,<pdop>,<hdop>,<vdop>[,<system id>]*hh
+    const char* fields[NMEA_MAX_FIELDS];
+    uint8_t fieldCount = splitFields(sentence, length, fields);
+    if (fieldCount < 18) {
+        return false;
+    }
+
+    sky.fixType = parseUInt(fields[2]);
+    sky.pdop = parseDecimal(fields[15]);
+    sky.hdop = parseDecimal(fields[16]);
+    sky.vdop = parseDecimal(fields[17]);
+    sky.dopUpdated = millis();
+
+    // Talker, then NMEA 4.1 system ID, then the ID range of the first satellite
+    GNSSConstellation constellation = constellationFromTalker(sentence + 1);
+    if (constellation == GNSS_CONSTELLATION_COUNT && fieldCount >= 19 && !fieldEmpty(fields[18])) {
+        switch (parseUInt(fields[18])) {
+            case 1: constellation = GNSS_CONSTELLATION_GPS; break;
+            case 2: constellation = GNSS_CONSTELLATION_GLONASS; break;
+            case 3: constellation = GNSS_CONSTELLATION_GALILEO; break;
+            case 4: constellation = GNSS_CONSTELLATION_BEIDOU; break;
+            default: break;
+        }
+    }
+    if (constellation == GNSS_CONSTELLATION_COUNT && !fieldEmpty(fields[3])) {
+        constellation = constellationFromPrn(parseUInt(fields[3]));
+    }
+    if (constellation == GNSS_CONSTELLATION_COUNT) {
+        return true;  // No satellites listed, DOP still updated
+    }
+
+    GNSSConstellationView& view = sky.constellations[constellation];
+    view.used = 0;
+    for (uint8_t i = 0; i < NMEA_GSA_MAX_USED; i++) {
+        if (!fieldEmpty(fields[3 + i])) {
+            view.usedPrns[view.used++] = parseUInt(fields[3 + i]);
+        }
+    }
+    markUsed(view);
+    return true;
+}
+
+bool NMEAParser::parseRMC(const char* sentence, size_t length) {
+    // $xxRMC,<time>,<status>,<lat>,<N/S>,<lon>,<E/W>,<speed kn>,<course>,<ddmmyy>,...*hh
+    const char* fields[NMEA_MAX_FIELDS];
+    uint8_t fieldCount = splitFields(sentence, length, fields);
+    if (fieldCount < 10) {
+        return false;
+    }
+
+    fix.valid = (*fields[2] == 'A') && !fieldEmpty(fields[3]) && !fieldEmpty(fields[5]);
+    if (fix.valid) {
+        fix.latitude = parseCoordinate(fields[3], fields[4]);
+        fix.longitude = parseCoordinate(fields[5], fields[6]);
+        fix.speedKnots = parseDecimal(fields[7]);
+        fix.courseOverGround = parseDecimal(fields[8]);
+    }
+    // Time and date are valid before the position (receiver clock from the first satellite)
+    fix.epochMs = quectelParseNMEATime(fields[1], fields[9]);
+    fix.updated = millis();
+    return true;
+}
+
+bool NMEAParser::parseGGA(const char* sentence, size_t length) {
+    // $xxGGA,<time>,<lat>,<N/S>,<lon>,<E/W>,<quality>,<sats>,<hdop>,<alt>,M,...*hh
+    const char* fields[NMEA_MAX_FIELDS];
+    uint8_t fieldCount = splitFields(sentence, length, fields);
+    if (fieldCount < 10) {
+        return false;
+    }
+
+    fix.quality = parseUInt(fields[6]);
+    fix.satellites = parseUInt(fields[7]);
+    fix.hdop = parseDecimal(fields[8]);
+    float altitude = parseDecimal(fields[9] + (*fields[9] == '-' ? 1 : 0));
+    fix.altitude = (*fields[9] == '-') ? -altitude : altitude;
+    return true;
+}
+
+uint8_t NMEAParser::getTrackedCount(GNSSConstellation constellation, uint8_t minSnr) const {
+    const GNSSConstellationView& view = sky.constellations[constellation];
+    uint8_t tracked = 0;
+    for (uint8_t i = 0; i < view.count; i++) {
+        if (view.satellites[i].snr >= minSnr && view.satellites[i].snr > 0) {
+            tracked++;
+        }
+    }
+    return tracked;
+}
+
+float NMEAParser::getAverageSnr(GNSSConstellation constellation) const {
+    const GNSSConstellationView& view = sky.constellations[constellation];
+    uint16_t sum = 0;
+    uint8_t tracked = 0;
+    for (uint8_t i = 0; i < view.count; i++) {
+        if (view.satellites[i].snr > 0) {
+            sum += view.satellites[i].snr;
+            tracked++;
+        }
+    }
+    return tracked > 0 ? (float)sum / tracked : 0;
+}
@@ -0,0 +1,153 @@
+/**
+ * NMEAParser.h - Allocation-free NMEA sentence parser for QuectelEC200U
+ *
+ * Maintains per-constellation satellite tables (GPS, GLONASS, BeiDou,
+ * Galileo) from GSV sentences, DOP/used-satellite data from GSA sentences
+ * and the latest fix from RMC (position, velocity, UTC epoch) and GGA
+ * (quality, satellites, HDOP, altitude) sentences. Tables are
+ * fixed arrays updated incrementally as sentences arrive; no heap is used.
+ *
+ * Author: ESP32 Arduino Library
+ * Date: 2024
+ */
+
+#ifndef NMEA_PARSER_H
+#define NMEA_PARSER_H
+
+#include <Arduino.h>
+#include "QuectelTime.h"
+
+// Satellites kept per constellation
+#ifndef NMEA_MAX_SATELLITES
+#define NMEA_MAX_SATELLITES 20
+#endif
+
+// Longest sentence accepted, excluding CR/LF (NMEA 0183 allows 80)
+#ifndef NMEA_MAX_SENTENCE
+#define NMEA_MAX_SENTENCE 120
+#endif
+
+// Satellites listed per GSA sentence
+#define NMEA_GSA_MAX_USED 12
+
+// GNSS Constellation
+enum GNSSConstellation {
+    GNSS_CONSTELLATION_GPS = 0,
+    GNSS_CONSTELLATION_GLONASS = 1,
+    GNSS_CONSTELLATION_BEIDOU = 2,
+    GNSS_CONSTELLATION_GALILEO = 3,
+    GNSS_CONSTELLATION_COUNT = 4
+};
+
+// Satellite Data (from GSV)
+struct GNSSSatellite {
+    uint16_t prn;          // Satellite ID as reported by the modem
+    uint8_t elevation;     // Degrees (0-90)
+    uint16_t azimuth;      // Degrees (0-359)
+    uint8_t snr;           // C/N0 in dB-Hz, 0 = not tracked
+    bool used;             // Listed in GSA (used in the solution)
+};
+
+// Satellites of one constellation
+struct GNSSConstellationView {
+    GNSSSatellite satellites[NMEA_MAX_SATELLITES];
+    uint8_t count;         // Entries in satellites[]
+    uint8_t inView;        // Satellites in view as reported by GSV (may exceed count)
+    uint8_t used;          // Satellites used in the solution (GSA)
+    uint16_t usedPrns[NMEA_GSA_MAX_USED];
+    uint8_t signalId;      // NMEA 4.1 GSV signal ID the table is built from, 0 = not reported
+    unsigned long updated; // millis() when the last GSV cycle completed
+};
+
+// Sky View Data Structure
+struct GNSSSkyView {
+    GNSSConstellationView constellations[GNSS_CONSTELLATION_COUNT];
+    float pdop;
+    float hdop;
+    float vdop;
+    uint8_t fixType;       // GSA: 1=no fix, 2=2D, 3=3D
+    unsigned long dopUpdated; // millis() of the last GSA sentence
+};
+
+// Fix Data (from RMC and GGA)
+struct NMEAFix {
+    bool valid;            // RMC status 'A'
+    double latitude;       // Decimal degrees
+    double longitude;      // Decimal degrees
+    float speedKnots;
+    float courseOverGround; // Degrees
+    uint64_t epochMs;      // Unix time in ms (UTC), 0 if time/date missing
+    unsigned long updated; // millis() when the RMC sentence was parsed
+    uint8_t quality;       // GGA fix quality, 0 = no fix
+    uint8_t satellites;    // GGA satellites used
+    float hdop;            // GGA horizontal dilution of precision
+    float altitude;        // GGA metres above mean sea level
+};
+
+class NMEAParser {
+private:
+    GNSSSkyView sky;
+    NMEAFix fix;
+
+    bool parseGSV(const char* sentence, size_t length);
+    bool parseGSA(const char* sentence, size_t length);
+    bool parseRMC(const char* sentence, size_t length);
+    bool parseGGA(const char* sentence, size_t length);
+    void markUsed(GNSSConstellationView& view);
+
+public:
+    NMEAParser();
+
+    /**
+     * Parse one sentence ("$xxYYY,...*hh"); the checksum is verified if present
+     * @param sentence Sentence text (need not be null terminated; nothing
+     *                 past length is read)
+     * @param length Sentence length, excluding any CR/LF
+     * @return true if the sentence was valid and recognised, false also for
+     *         sentences longer than NMEA_MAX_SENTENCE
+     */
+    bool parse(const char* sentence, size_t length);
+    bool parse(const char* sentence) { return parse(sentence, strlen(sentence)); }
+
+    /**
+     * Clear all tables
+     */
+    void reset();
+
+    const GNSSSkyView& getSkyView() const { return sky; }
+
+    /**
+     * Get the fix from the last RMC and GGA sentences
+     */
+    const NMEAFix& getFix() const { return fix; }
+    const GNSSConstellationView& getConstellation(GNSSConstellation constellation) const {
+        return sky.constellations[constellation];
+    }
+
+    /**
+     * Count tracked satellites of a constellation
+     * @param constellation Constellation to inspect
+     * @param minSnr Minimum C/N0 in dB-Hz
+     * @return Satellites with snr >= minSnr
+     */
+    uint8_t getTrackedCount(GNSSConstellation constellation, uint8_t minSnr = 1) const;
+
+    /**
+     * Average C/N0 of the tracked satellites of a constellation
+     * @return dB-Hz, 0 if none tracked
+     */
+    float getAverageSnr(GNSSConstellation constellation) const;
+
+    /**
+     * Map an NMEA talker ID ("GP", "GL", "GB"/"BD", "GA") to a constellation
+     * @return Constellation, or GNSS_CONSTELLATION_COUNT if unknown or "GN"
+     */
+    static GNSSConstellation constellationFromTalker(const char* talker);
+
+    /**
+     * Map a satellite ID to a constellation using the NMEA ID ranges
+     */
+    static GNSSConstellation constellationFromPrn(uint16_t prn);
+};
+
+#endif // NMEA_PARSER_H
@@ -11,6 +11,57 @@
  */
 
 #include "QuectelEC200U.h"
+#include "GNSSFilter.h"
+#include "Geofence.h"
+#include "TrackSimplifier.h"
+#include "QuectelTime.h"
+#include <limits.h>
+
+// User equivalent range error used to turn HDOP into an accuracy estimate
+#define GNSS_UERE_METERS 5.0f
+
+// Poll interval while measuring time to first fix
+#define GNSS_TTFF_POLL_MS 250
+
+// Silence on the NMEA port that separates one epoch's sentence burst from the next
+#define NMEA_BURST_GAP_US 20000
+
+// Error bound of stream fix times on top of the poll window (output latency jitter)
+#define NMEA_TIME_UNCERTAINTY_US 2000
+
+// NTP refresh inside getBestTime(): one query with a short wait, so an
+// unreachable server does not stall a time lookup
+#define BEST_TIME_NTP_TIMEOUT_MS 5000
+
+// Recovery escalation timing
+#define RECOVERY_CFUN_TIMEOUT_MS 15000
+#define RECOVERY_RESET_PULSE_MS 300        // RESET_N low
+#define RECOVERY_PWRKEY_OFF_PULSE_MS 800   // Long enough to power down
+#define RECOVERY_PWRKEY_ON_PULSE_MS 600    // Powers up, too short to power down
+#define RECOVERY_POWER_OFF_WAIT_MS 3000
+#define RECOVERY_BOOT_SETTLE_MS 3000       // Before the first AT after a reboot
+#define RECOVERY_BOOT_TIMEOUT_MS 30000
+#define RECOVERY_BACKOFF_MIN_MS 30000UL
+#define RECOVERY_BACKOFF_MAX_MS 900000UL
+
+#if !QUECTEL_TRACE
+// Log AT traffic in pieces that fit a log line, so long responses are not cut
+static void logTraffic(const char* direction, const String& text) {
+    const int piece = QUECTEL_LOG_LINE_MAX - 8;
+    int length = text.length();
+    int offset = 0;
+    do {
+        int n = (length - offset < piece) ? length - offset : piece;
+        QLOG_TRACE("%s %.*s", direction, n, text.c_str() + offset);
+        offset += n;
+    } while (offset < length);
+}
+#endif
+
+// Transfer time of bytes over an 8N1 UART
+static int64_t uartTransferUs(size_t bytes, uint32_t baud) {
+    return (int64_t)bytes * 10000000LL / baud;
+}
 
 // Constructor
 QuectelEC200U::QuectelEC200U(HardwareSerial* serial, uint32_t baud) {
@@ -19,6 +70,72 @@ QuectelEC200U::QuectelEC200U(HardwareSerial* serial, uint32_t baud) {
     timeout = 5000;  // Default 5 second timeout
     transparentMode = false;
     currentSSLClient = -1;
+    acqMinPollMs = 500;
+    acqMaxPollMs = 8000;
+    fixSeen = false;
+    lastFixTime = 0;
+    fixCacheWindowMs = 2000;
+    positionFilter = nullptr;
+    reportFilter = nullptr;
+    geofenceEngine = nullptr;
+    trackSimplifier = nullptr;
+
+    gnssState = GNSS_STATE_OFF;
+    gnssStateSince = 0;
+    gnssPowerOnTime = 0;
+    gnssFirstFixPending = false;
+    memset(&gnssPowerStats, 0, sizeof(gnssPowerStats));
+    gnssPowerStats.acquireEstimateMs = 30000;  // Conservative until learned
+    gnssCurrentMa[GNSS_STATE_OFF] = 0;
+    gnssCurrentMa[GNSS_STATE_ACQUIRING] = 40;
+    gnssCurrentMa[GNSS_STATE_FIXED] = 30;
+    dutyIntervalMs = 0;
+    dutyTargetHdop = 2.0;
+    dutyAcquireTimeoutMs = 60000;
+    dutyHeartbeatMs = 900000;
+    dutyStrategy = GNSS_DUTY_AUTO;
+    dutyFixTaken = false;
+    dutyLastFixTime = 0;
+    motionAware = false;
+    motionPending = false;
+    invalidateGNSSConfig();
+    cellAccuracyMeters = 1000;
+    nmeaStream = nullptr;
+    nmeaLineLength = 0;
+    nmeaPosition.valid = false;
+    nmeaPositionTime = 0;
+    nmeaByteUs = 10000000UL / 115200;
+    nmeaLastByteUs = 0;
+    nmeaPollUs = 0;
+    nmeaBurstUs = 0;
+    nmeaBurstUncertaintyUs = 0;
+    nmeaLatencyMs = 0;
+    responseTicksUs = 0;
+    daylightSaving = false;
+    urcLineLength = 0;
+    timeZoneReports = false;
+    timeZoneCallback = nullptr;
+    timeZoneContext = nullptr;
+    memset(&lastStatus, 0, sizeof(lastStatus));
+    lastStatus.cmeError = -1;
+    statusStartTime = 0;
+    statusBytesOut = 0;
+    memset(&health, 0, sizeof(health));
+    health.state = MODEM_HEALTHY;
+    recoveryThreshold = 3;
+    pwrkeyPin = -1;
+    resetPin = -1;
+    pinAssertLevel = HIGH;
+    outageStart = 0;
+    nextRecoveryTime = 0;
+    recovering = false;
+    recoveryCallback = nullptr;
+    recoveryContext = nullptr;
+}
+
+QuectelEC200U::QuectelEC200U(HardwareSerial* serial, Stream* nmeaSerial, uint32_t baud)
+    : QuectelEC200U(serial, baud) {
+    nmeaStream = nmeaSerial;
 }
 
 // ========== Basic Modem Control ==========
@@ -32,7 +149,7 @@ bool QuectelEC200U::begin() {
 
     // Test AT command
     if (!testAT()) {
-        DEBUG_PRINTLN("Modem not responding to AT commands");
+        QLOG_ERROR("Modem not responding to AT commands");
         return false;
     }
 
@@ -102,21 +219,205 @@ bool QuectelEC200U::getNetworkStatus(int& status) {
     return false;
 }
 
+// ========== Health Watchdog ==========
+
+void QuectelEC200U::setRecoveryPins(int pwrkeyGpio, int resetGpio, uint8_t assertLevel) {
+    pwrkeyPin = pwrkeyGpio;
+    resetPin = resetGpio;
+    pinAssertLevel = assertLevel;
+    uint8_t idleLevel = (assertLevel == HIGH) ? LOW : HIGH;
+    if (pwrkeyPin >= 0) {
+        digitalWrite(pwrkeyPin, idleLevel);
+        pinMode(pwrkeyPin, OUTPUT);
+    }
+    if (resetPin >= 0) {
+        digitalWrite(resetPin, idleLevel);
+        pinMode(resetPin, OUTPUT);
+    }
+}
+
+void QuectelEC200U::noteHealth(int code, bool garbage) {
+    if (recovering || health.state == MODEM_DOWN) {
+        return;
+    }
+
+    // Any final result code, ERROR included, means the modem is alive
+    if (code != AT_TIMEOUT) {
+        if (health.state == MODEM_UNRESPONSIVE) {
+            endOutage();  // Came back before recovery ran
+        }
+        health.consecutiveFailures = 0;
+        health.state = MODEM_HEALTHY;
+        return;
+    }
+
+    if (garbage) {
+        health.garbageResponses++;
+    } else {
+        health.timeouts++;
+    }
+    if (health.consecutiveFailures == 0) {
+        outageStart = millis();
+    }
+    if (health.consecutiveFailures < UINT8_MAX) {
+        health.consecutiveFailures++;
+    }
+    if (health.consecutiveFailures < recoveryThreshold) {
+        health.state = MODEM_DEGRADED;
+    } else if (health.state != MODEM_UNRESPONSIVE) {
+        QLOG_WARN("Modem unresponsive after %u failed commands", health.consecutiveFailures);
+        health.outages++;
+        health.state = MODEM_UNRESPONSIVE;
+        nextRecoveryTime = millis();
+    }
+}
+
+void QuectelEC200U::endOutage() {
+    unsigned long downtime = millis() - outageStart;
+    health.downtimeMs += downtime;
+    health.lastDowntimeMs = downtime;
+    if (downtime > health.longestDowntimeMs) {
+        health.longestDowntimeMs = downtime;
+    }
+}
+
+void QuectelEC200U::pulsePin(int pin, unsigned long ms) {
+    digitalWrite(pin, pinAssertLevel);
+    serviceDelay(ms);
+    digitalWrite(pin, pinAssertLevel == HIGH ? LOW : HIGH);
+}
+
+bool QuectelEC200U::waitForBoot() {
+    serviceDelay(RECOVERY_BOOT_SETTLE_MS);
+    unsigned long startTime = millis();
+    while (millis() - startTime < RECOVERY_BOOT_TIMEOUT_MS) {
+        if (sendATCommand("AT", 1000)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool QuectelEC200U::runRecoveryStep(ModemRecoveryStep step) {
+    switch (step) {
+        case RECOVERY_AT_PROBE:
+            if (transparentMode) {
+                exitTransparentMode();
+            }
+            return testAT();
+        case RECOVERY_CFUN_RESET:
+            return sendATCommand("AT+CFUN=1,1", RECOVERY_CFUN_TIMEOUT_MS) && waitForBoot();
+        case RECOVERY_RESET_PIN:
+            pulsePin(resetPin, RECOVERY_RESET_PULSE_MS);
+            return waitForBoot();
+        case RECOVERY_POWER_CYCLE:
+            pulsePin(pwrkeyPin, RECOVERY_PWRKEY_OFF_PULSE_MS);
+            serviceDelay(RECOVERY_POWER_OFF_WAIT_MS);
+            pulsePin(pwrkeyPin, RECOVERY_PWRKEY_ON_PULSE_MS);
+            return waitForBoot();
+        default:
+            return false;
+    }
+}
+
+bool QuectelEC200U::recoverModem() {
+    if (health.state == MODEM_HEALTHY || health.state == MODEM_DEGRADED) {
+        // Called directly: the outage starts now unless failures already started it
+        if (health.consecutiveFailures == 0) {
+            outageStart = millis();
+        }
+        health.outages++;
+    }
+
+    recovering = true;
+    ModemRecoveryStep recoveredBy = RECOVERY_NONE;
+    for (int i = RECOVERY_AT_PROBE; i < RECOVERY_STEP_COUNT; i++) {
+        ModemRecoveryStep step = (ModemRecoveryStep)i;
+        if ((step == RECOVERY_RESET_PIN && resetPin < 0) ||
+            (step == RECOVERY_POWER_CYCLE && pwrkeyPin < 0)) {
+            continue;
+        }
+        QLOG_WARN("Recovery step %d", i);
+        bool success = runRecoveryStep(step);
+        if (recoveryCallback != nullptr) {
+            recoveryCallback(step, success, recoveryContext);
+        }
+        if (success) {
+            recoveredBy = step;
+            break;
+        }
+    }
+
+    if (recoveredBy == RECOVERY_NONE) {
+        recovering = false;
+        health.failedRecoveries++;
+        health.backoffMs = (health.backoffMs == 0) ? RECOVERY_BACKOFF_MIN_MS
+                                                   : min(health.backoffMs * 2, RECOVERY_BACKOFF_MAX_MS);
+        nextRecoveryTime = millis() + health.backoffMs;
+        health.state = MODEM_DOWN;
+        QLOG_ERROR("Modem recovery failed, retrying in %lu ms", health.backoffMs);
+        return false;
+    }
+
+    // Settings a reboot loses
+    sendATCommand("ATE0");
+    sendATCommand("AT+CMEE=2");
+    if (recoveredBy >= RECOVERY_CFUN_RESET) {
+        transparentMode = false;
+        currentSSLClient = -1;
+        fixSeen = false;
+        invalidateGNSSConfig();
+        setGNSSState(GNSS_STATE_OFF);
+        if (timeZoneReports) {
+            setTimeZoneReporting(true);
+        }
+    }
+    recovering = false;
+
+    health.recoveries[recoveredBy]++;
+    endOutage();
+    health.consecutiveFailures = 0;
+    health.backoffMs = 0;
+    health.state = MODEM_HEALTHY;
+    return true;
+}
+
+ModemHealthState QuectelEC200U::healthService() {
+    if ((health.state == MODEM_UNRESPONSIVE || health.state == MODEM_DOWN) &&
+        (long)(millis() - nextRecoveryTime) >= 0) {
+        recoverModem();
+    }
+    return health.state;
+}
+
+void QuectelEC200U::resetHealthStats() {
+    ModemHealthState state = health.state;
+    uint8_t failures = health.consecutiveFailures;
+    unsigned long backoffMs = health.backoffMs;
+    memset(&health, 0, sizeof(health));
+    health.state = state;
+    health.consecutiveFailures = failures;
+    health.backoffMs = backoffMs;
+}
+
 // ========== Helper Functions ==========
 
 bool QuectelEC200U::sendATCommand(const String& command, unsigned long customTimeout) {
+    if (failFast(command)) {
+        return false;
+    }
     clearBuffer();
 
-    DEBUG_PRINT(">> ");
-    DEBUG_PRINTLN(command);
+    traceCommand(command);
 
+    beginStatus(command);
     modemSerial->println(command);
 
     unsigned long timeoutMs = (customTimeout > 0) ? customTimeout : timeout;
     String response = readResponse(timeoutMs);
+    endStatus(parseATResponse(response), 0, response.length());
 
-    DEBUG_PRINT("<< ");
-    DEBUG_PRINTLN(response);
+    traceResponse(response);
 
     return (response.indexOf("OK") >= 0);
 }
@@ -138,13 +439,16 @@ String QuectelEC200U::readResponse(unsigned long customTimeout) {
                 response.endsWith("NO CARRIER\r\n") ||
                 response.endsWith("SEND OK\r\n") ||
                 response.endsWith("SEND FAIL\r\n") ||
-                response.indexOf("+CME ERROR:") >= 0) {
+                (response.endsWith("\r\n") && response.indexOf("+CME ERROR:") >= 0)) {
+                responseTicksUs = quectelTicksUs();
+                handleResponseURCs(response);
                 return response;
             }
         }
-        delay(10);
+        serviceDelay(10);
     }
 
+    handleResponseURCs(response);
     return response;
 }
 
@@ -155,14 +459,14 @@ bool QuectelEC200U::waitForResponse(const String& expected, unsigned long custom
 
 int QuectelEC200U::parseATResponse(const String& response) {
     if (response.indexOf("OK") >= 0) return AT_OK;
+    if (response.indexOf("+CME ERROR:") >= 0) {
+        return AT_CME_ERROR - parseCMEError(response);
+    }
     if (response.indexOf("ERROR") >= 0) return AT_ERROR;
     if (response.indexOf("CONNECT") >= 0) return AT_CONNECT;
     if (response.indexOf("NO CARRIER") >= 0) return AT_NO_CARRIER;
     if (response.indexOf("SEND OK") >= 0) return AT_SEND_OK;
     if (response.indexOf("SEND FAIL") >= 0) return AT_SEND_FAIL;
-    if (response.indexOf("+CME ERROR:") >= 0) {
-        return AT_CME_ERROR - parseCMEError(response);
-    }
     return AT_TIMEOUT;
 }
 
@@ -190,92 +494,945 @@ int QuectelEC200U::parseSSLError(const String& response) {
     return -1;
 }
 
+void QuectelEC200U::beginStatus(const String& command) {
+    size_t length = min((size_t)command.length(), (size_t)QUECTEL_STATUS_CMD_LEN - 1);
+    memcpy(lastStatus.command, command.c_str(), length);
+    lastStatus.command[length] = '\0';
+    statusStartTime = millis();
+    statusBytesOut = command.length() + 2;  // println adds CR/LF
+}
+
+int QuectelEC200U::endStatus(int code, int sslError, size_t responseLength) {
+    lastStatus.code = code;
+    lastStatus.cmeError = (code <= AT_CME_ERROR) ? AT_CME_ERROR - code : -1;
+    lastStatus.sslError = sslError;
+    lastStatus.elapsedMs = millis() - statusStartTime;
+#if QUECTEL_METRICS
+    bool error = (code == AT_ERROR || code <= AT_CME_ERROR || code == AT_NO_CARRIER ||
+                  code == AT_SEND_FAIL || sslError != 0);
+    metrics.record(lastStatus.command, lastStatus.elapsedMs, statusBytesOut, responseLength,
+                   error, code == AT_TIMEOUT);
+#endif
+    noteHealth(code, responseLength > 0);
+    return code;
+}
+
+void QuectelEC200U::traceCommand(const String& command) {
+#if QUECTEL_TRACE
+    trace.record(TRACE_TX, command.c_str(), command.length());
+#else
+    logTraffic(">>", command);
+#endif
+}
+
+void QuectelEC200U::traceResponse(const String& response) {
+#if QUECTEL_TRACE
+    trace.record(TRACE_RX, response.c_str(), response.length());
+#else
+    logTraffic("<<", response);
+#endif
+}
+
+bool QuectelEC200U::failFast(const String& command) {
+    if (health.state != MODEM_DOWN || recovering) {
+        return false;
+    }
+    beginStatus(command);
+    statusBytesOut = 0;  // Not sent
+    endStatus(AT_TIMEOUT);
+    return true;
+}
+
 void QuectelEC200U::clearBuffer() {
-    while (modemSerial->available()) {
-        modemSerial->read();
+    // Anything waiting is unsolicited; dispatch it before the next command
+    processURCs();
+    urcLineLength = 0;
+}
+
+// ========== GNSS/GPS Functions ==========
+
+bool QuectelEC200U::gnssBegin() {
+    // Configure GNSS parameters if needed
+    return setNMEASource(true);  // Enable NMEA output
+}
+
+bool QuectelEC200U::gnssOn(int mode, int fixMaxTime) {
+    String cmd = "AT+QGPS=" + String(mode);
+    if (fixMaxTime != 30) {
+        cmd += "," + String(fixMaxTime);
+    }
+    if (!sendATCommand(cmd)) {
+        return false;
+    }
+    if (gnssState == GNSS_STATE_OFF) {
+        setGNSSState(GNSS_STATE_ACQUIRING);
+    }
+    return true;
+}
+
+bool QuectelEC200U::gnssOff() {
+    fixSeen = false;
+    if (!sendATCommand("AT+QGPSEND")) {
+        return false;
+    }
+    setGNSSState(GNSS_STATE_OFF);
+    return true;
+}
+
+// ========== GNSS Configuration ==========
+
+// AT+QGPSCFG setting names, indexed by GNSSConstellation
+static const char* const nmeaTypeSettings[GNSS_CONSTELLATION_COUNT] = {
+    "gpsnmeatype", "glonassnmeatype", "beidounmeatype", "galileonmeatype"
+};
+
+bool QuectelEC200U::applyGNSSConfig(const char* name, int value, int& cached, const char* valueText) {
+    if (cached == value) {
+        return true;  // Already active, skip the AT round trip
+    }
+
+    String cmd = "AT+QGPSCFG=\"";
+    cmd += name;
+    cmd += "\",";
+    if (valueText != nullptr) {
+        cmd += "\"";
+        cmd += valueText;
+        cmd += "\"";
+    } else {
+        cmd += String(value);
+    }
+
+    String response;
+    int result = sendRawATCommand(cmd, response);
+    if (result != AT_OK) {
+        QLOG_WARN("GNSS config rejected: %s", name);
+        return false;
+    }
+    cached = value;
+    return true;
+}
+
+bool QuectelEC200U::queryGNSSConfig(const char* name, String& value) {
+    String cmd = "AT+QGPSCFG=\"";
+    cmd += name;
+    cmd += "\"";
+
+    String response;
+    if (sendRawATCommand(cmd, response) != AT_OK) {
+        return false;
+    }
+
+    // +QGPSCFG: "<name>",<value>[,...]
+    int idx = response.indexOf("+QGPSCFG: ");
+    if (idx < 0) {
+        return false;
+    }
+    idx = response.indexOf(',', idx);
+    if (idx < 0) {
+        return false;
+    }
+    int endIdx = response.indexOf('\r', idx);
+    value = response.substring(idx + 1, endIdx > idx ? endIdx : response.length());
+    value.replace("\"", "");
+    value.trim();
+    return value.length() > 0;
+}
+
+bool QuectelEC200U::setGNSSConstellations(GNSSConstellationConfig config) {
+    return applyGNSSConfig("gnssconfig", config, gnssConfig.constellations);
+}
+
+bool QuectelEC200U::setNMEATypes(GNSSConstellation constellation, uint8_t typeMask) {
+    if (constellation >= GNSS_CONSTELLATION_COUNT) {
+        return false;
+    }
+    return applyGNSSConfig(nmeaTypeSettings[constellation], typeMask, gnssConfig.nmeaTypes[constellation]);
+}
+
+bool QuectelEC200U::setNMEAOutputPort(GNSSNMEAPort port) {
+    static const char* const names[] = { "none", "usbnmea", "uartnmea" };
+    if (port > GNSS_NMEA_PORT_UART) {
+        return false;
+    }
+    return applyGNSSConfig("outport", port, gnssConfig.outputPort, names[port]);
+}
+
+bool QuectelEC200U::setNMEAOutputRate(uint8_t hz) {
+    if (hz == 0) {
+        return false;
+    }
+    return applyGNSSConfig("fixfreq", hz, gnssConfig.fixRateHz);
+}
+
+bool QuectelEC200U::setNMEASource(bool enable) {
+    return applyGNSSConfig("nmeasrc", enable ? 1 : 0, gnssConfig.nmeaSource);
+}
+
+bool QuectelEC200U::readGNSSConfig() {
+    bool complete = true;
+    String value;
+
+    invalidateGNSSConfig();
+
+    if (queryGNSSConfig("gnssconfig", value)) gnssConfig.constellations = value.toInt();
+    else complete = false;
+    if (queryGNSSConfig("nmeasrc", value)) gnssConfig.nmeaSource = value.toInt();
+    else complete = false;
+    if (queryGNSSConfig("fixfreq", value)) gnssConfig.fixRateHz = value.toInt();
+    else complete = false;
+
+    if (queryGNSSConfig("outport", value)) {
+        if (value == "none") gnssConfig.outputPort = GNSS_NMEA_PORT_NONE;
+        else if (value == "usbnmea") gnssConfig.outputPort = GNSS_NMEA_PORT_USB;
+        else if (value == "uartnmea") gnssConfig.outputPort = GNSS_NMEA_PORT_UART;
+        else complete = false;
+    } else {
+        complete = false;
+    }
+
+    for (int i = 0; i < GNSS_CONSTELLATION_COUNT; i++) {
+        if (queryGNSSConfig(nmeaTypeSettings[i], value)) gnssConfig.nmeaTypes[i] = value.toInt();
+        else complete = false;
+    }
+    return complete;
+}
+
+void QuectelEC200U::invalidateGNSSConfig() {
+    gnssConfig.constellations = -1;
+    gnssConfig.nmeaSource = -1;
+    gnssConfig.outputPort = -1;
+    gnssConfig.fixRateHz = -1;
+    for (int i = 0; i < GNSS_CONSTELLATION_COUNT; i++) {
+        gnssConfig.nmeaTypes[i] = -1;
+    }
+}
+
+// ========== GNSS Power Management ==========
+
+void QuectelEC200U::setGNSSState(GNSSEngineState state) {
+    unsigned long now = millis();
+    unsigned long elapsed = now - gnssStateSince;
+
+    gnssPowerStats.timeInState[gnssState] += elapsed;
+    gnssPowerStats.energyMah += gnssCurrentMa[gnssState] * elapsed / 3600000.0f;
+    gnssStateSince = now;
+
+    if (state == gnssState) {
+        return;
+    }
+
+    if (state == GNSS_STATE_ACQUIRING && gnssState == GNSS_STATE_OFF) {
+        gnssPowerStats.powerOnCount++;
+        gnssPowerOnTime = now;
+        gnssFirstFixPending = true;
+    } else if (state == GNSS_STATE_FIXED && gnssFirstFixPending) {
+        // Learn the power-on to first fix time (EWMA, 1/4 weight)
+        unsigned long acquireMs = now - gnssPowerOnTime;
+        gnssPowerStats.acquireEstimateMs = (gnssPowerStats.acquireEstimateMs * 3 + acquireMs) / 4;
+        gnssPowerStats.lastTtffMs = acquireMs;
+        gnssFirstFixPending = false;
+    } else if (state == GNSS_STATE_OFF) {
+        gnssFirstFixPending = false;
+    }
+    gnssState = state;
+}
+
+void QuectelEC200U::noteGNSSError(int cmeError) {
+    // Keep the tracked engine state in line with what the modem reports
+    if (cmeError == CME_SESSION_NOT_ACTIVE) {
+        setGNSSState(GNSS_STATE_OFF);
+    } else if (cmeError == CME_NOT_FIXED_NOW) {
+        setGNSSState(GNSS_STATE_ACQUIRING);
+    }
+}
+
+void QuectelEC200U::noteGNSSFix(unsigned long fixTime) {
+    fixSeen = true;
+    lastFixTime = fixTime;
+    // A fix read after gnssOff() must not start FIXED time-in-state
+    if (gnssState != GNSS_STATE_OFF) {
+        setGNSSState(GNSS_STATE_FIXED);
+    }
+}
+
+const GNSSPowerStats& QuectelEC200U::getGNSSPowerStats() {
+    setGNSSState(gnssState);  // Account time up to now
+    return gnssPowerStats;
+}
+
+void QuectelEC200U::gnssSetPowerModel(float acquiringMa, float trackingMa, float offMa) {
+    setGNSSState(gnssState);  // Close the interval under the old model
+    gnssCurrentMa[GNSS_STATE_OFF] = offMa;
+    gnssCurrentMa[GNSS_STATE_ACQUIRING] = acquiringMa;
+    gnssCurrentMa[GNSS_STATE_FIXED] = trackingMa;
+}
+
+void QuectelEC200U::gnssSetDutyCycle(unsigned long fixIntervalMs, float targetHdop,
+                                     GNSSDutyStrategy strategy, unsigned long acquireTimeoutMs) {
+    dutyIntervalMs = fixIntervalMs;
+    dutyTargetHdop = targetHdop;
+    dutyStrategy = strategy;
+    dutyAcquireTimeoutMs = acquireTimeoutMs;
+    dutyFixTaken = false;
+}
+
+GNSSDutyStrategy QuectelEC200U::gnssGetActiveStrategy() {
+    if (dutyStrategy != GNSS_DUTY_AUTO) {
+        return dutyStrategy;
+    }
+
+    // Energy per fix interval: staying on vs. one power-on acquisition.
+    // The learned acquisition time grows by itself once off-periods get long
+    // enough to turn hot starts into warm/cold starts.
+    float continuousMah = gnssCurrentMa[GNSS_STATE_FIXED] * dutyIntervalMs;
+    float periodicMah = gnssCurrentMa[GNSS_STATE_ACQUIRING] * gnssPowerStats.acquireEstimateMs +
+                        gnssCurrentMa[GNSS_STATE_OFF] * dutyIntervalMs;
+    if (dutyIntervalMs <= gnssPowerStats.acquireEstimateMs || continuousMah <= periodicMah) {
+        return GNSS_DUTY_CONTINUOUS;
+    }
+    return motionAware ? GNSS_DUTY_MOTION : GNSS_DUTY_PERIODIC;
+}
+
+bool QuectelEC200U::gnssDutyCycleService(GNSSPosition& position) {
+    if (dutyIntervalMs == 0) {
+        return false;
+    }
+
+    GNSSDutyStrategy strategy = gnssGetActiveStrategy();
+    unsigned long sinceLastFix = millis() - dutyLastFixTime;
+    bool due;
+    if (!dutyFixTaken) {
+        due = true;
+    } else if (strategy == GNSS_DUTY_MOTION ||
+               (strategy == GNSS_DUTY_PERIODIC && reportFilter != nullptr && reportFilter->isStationary())) {
+        // Parked: power on for motion reports and heartbeats only
+        due = (motionPending && sinceLastFix >= dutyIntervalMs) || sinceLastFix >= dutyHeartbeatMs;
+    } else {
+        due = (sinceLastFix >= dutyIntervalMs);
+    }
+
+    if (!due) {
+        if (strategy != GNSS_DUTY_CONTINUOUS && gnssState != GNSS_STATE_OFF) {
+            gnssOff();
+        }
+        return false;
+    }
+
+    if (gnssState == GNSS_STATE_OFF && !gnssOn()) {
+        return false;
+    }
+
+    bool fixed = acquirePosition(position, dutyTargetHdop, dutyAcquireTimeoutMs);
+    dutyFixTaken = true;
+    dutyLastFixTime = millis();
+    if (fixed) {
+        gnssPowerStats.fixCount++;
+        motionPending = false;
+    } else {
+        gnssPowerStats.failedAcquisitions++;
+    }
+
+    if (strategy != GNSS_DUTY_CONTINUOUS) {
+        gnssOff();
+    }
+    return fixed;
+}
+
+bool QuectelEC200U::gnssSetStartMode(GNSSStartMode mode) {
+    // Assistance data can only be deleted while the engine is off
+    if (gnssState != GNSS_STATE_OFF && !gnssOff()) {
+        return false;
+    }
+    return sendATCommand("AT+QGPSDEL=" + String((int)mode));
+}
+
+bool QuectelEC200U::runTTFFBenchmark(GNSSStartMode mode, uint8_t runs, GNSSTTFFStats& stats,
+                                     unsigned long timeoutMs) {
+    memset(&stats, 0, sizeof(stats));
+    stats.mode = mode;
+    if (runs > GNSS_TTFF_MAX_RUNS) {
+        runs = GNSS_TTFF_MAX_RUNS;
+    }
+
+    unsigned long savedEstimate = gnssPowerStats.acquireEstimateMs;
+    unsigned long totalMs = 0;
+
+    for (uint8_t run = 0; run < runs; run++) {
+        stats.runs++;
+        if (!gnssSetStartMode(mode) || !gnssOn()) {
+            QLOG_WARN("TTFF run could not start GNSS");
+            continue;
+        }
+
+        // Poll on a fixed short interval so the resolution does not depend on the mode
+        bool fixed = false;
+        while (!fixed && millis() - gnssPowerOnTime < timeoutMs) {
+            String response;
+            int result = sendRawATCommand("AT+QGPSLOC=2", response, 5000);
+            if (result == AT_OK && response.indexOf("+QGPSLOC: ") >= 0) {
+                setGNSSState(GNSS_STATE_FIXED);
+                fixed = true;
+            } else if (result == AT_CME_ERROR - CME_NOT_FIXED_NOW) {
+                serviceDelay(GNSS_TTFF_POLL_MS);
+            } else {
+                break;
+            }
+        }
+
+        if (fixed) {
+            // Insertion sort keeps samples ordered for the percentiles
+            unsigned long ttff = gnssPowerStats.lastTtffMs;
+            uint8_t i = stats.fixes++;
+            while (i > 0 && stats.samples[i - 1] > ttff) {
+                stats.samples[i] = stats.samples[i - 1];
+                i--;
+            }
+            stats.samples[i] = ttff;
+            totalMs += ttff;
+            QLOG_INFO("TTFF run %d: %lu ms", run + 1, ttff);
+        } else {
+            QLOG_INFO("TTFF run %d: no fix", run + 1);
+        }
+    }
+
+    gnssOff();
+    gnssPowerStats.acquireEstimateMs = savedEstimate;
+
+    if (stats.fixes == 0) {
+        return false;
+    }
+    stats.minMs = stats.samples[0];
+    stats.maxMs = stats.samples[stats.fixes - 1];
+    stats.medianMs = stats.samples[(stats.fixes - 1) / 2];
+    stats.p90Ms = stats.samples[(stats.fixes * 9 + 9) / 10 - 1];
+    stats.meanMs = totalMs / stats.fixes;
+    return true;
+}
+
+bool QuectelEC200U::getPosition(GNSSPosition& position, GNSSCoordFormat format,
+                                int maxRetries, unsigned long retryDelay) {
+    position.valid = false;
+    position.source = POSITION_SOURCE_NONE;
+    position.lastError = 0;
+
+    if (format == GNSS_FORMAT_DECIMAL_DEGREES && fixCacheWindowMs > 0 &&
+        getNMEAPosition(position, fixCacheWindowMs)) {
+        return true;
+    }
+
+    for (int retry = 0; retry < maxRetries; retry++) {
+        String response;
+        String cmd = "AT+QGPSLOC=" + String(format);
+        int result = sendRawATCommand(cmd, response, 5000);
+
+        if (result == AT_OK) {
+            if (parseGNSSResponse(response, position, format)) {
+                noteGNSSFix(millis());
+                position.valid = true;
+                processFix(position);
+                return true;
+            }
+        } else if (result <= AT_CME_ERROR) {
+            int cmeError = AT_CME_ERROR - result;
+            position.lastError = cmeError;
+            noteGNSSError(cmeError);
+
+            // Check if error is temporary (not fixed yet)
+            if (cmeError == CME_NOT_FIXED_NOW) {
+                QLOG_TRACE("GNSS not fixed yet, retrying...");
+                serviceDelay(retryDelay);
+                continue;
+            } else if (cmeError == CME_SESSION_NOT_ACTIVE) {
+                QLOG_INFO("GNSS session not active, turning on GNSS...");
+                if (gnssOn()) {
+                    serviceDelay(2000);  // Give GNSS time to start
+                    continue;
+                }
+            }
+            // For other errors, stop retrying
+            break;
+        }
+
+        serviceDelay(retryDelay);
+    }
+
+    return false;
+}
+
+bool QuectelEC200U::getBestPosition(GNSSPosition& position, unsigned long gnssBudgetMs,
+                                    unsigned long cellTimeoutMs) {
+    position.valid = false;
+    position.source = POSITION_SOURCE_NONE;
+    position.lastError = 0;
+
+    // GNSS first, but only while it is running; a cold session cannot fix within seconds
+    if (gnssState != GNSS_STATE_OFF) {
+        unsigned long startTime = millis();
+        do {
+            String response;
+            int result = sendRawATCommand("AT+QGPSLOC=2", response, 5000);
+            if (result == AT_OK && parseGNSSResponse(response, position, GNSS_FORMAT_DECIMAL_DEGREES)) {
+                noteGNSSFix(millis());
+                position.valid = true;
+                processFix(position);
+                return true;
+            }
+            if (result > AT_CME_ERROR) {
+                break;
+            }
+            position.lastError = AT_CME_ERROR - result;
+            noteGNSSError(position.lastError);
+            if (position.lastError != CME_NOT_FIXED_NOW) {
+                break;
+            }
+            serviceDelay(acqMinPollMs);
+        } while (millis() - startTime < gnssBudgetMs);
+    }
+
+    QLOG_INFO("No GNSS fix, falling back to cell location");
+    return getCellLocation(position, cellTimeoutMs);
+}
+
+bool QuectelEC200U::getCellLocation(GNSSPosition& position, unsigned long timeoutMs) {
+    position.valid = false;
+    position.source = POSITION_SOURCE_NONE;
+    position.lastError = 0;
+
+    String response;
+    int result = sendRawATCommand("AT+QCELLLOC=1", response, timeoutMs);
+    if (result != AT_OK) {
+        if (result <= AT_CME_ERROR) {
+            position.lastError = AT_CME_ERROR - result;
+        }
+        return false;
+    }
+
+    // +QCELLLOC: <longitude>,<latitude>
+    int idx = response.indexOf("+QCELLLOC: ");
+    if (idx < 0) return false;
+    idx += 11;
+    int commaIdx = response.indexOf(',', idx);
+    if (commaIdx <= idx) return false;
+    int endIdx = response.indexOf('\r', commaIdx);
+    if (endIdx < 0) endIdx = response.length();
+
+    position.longitudeStr = response.substring(idx, commaIdx);
+    position.latitudeStr = response.substring(commaIdx + 1, endIdx);
+    position.longitude = position.longitudeStr.toDouble();
+    position.latitude = position.latitudeStr.toDouble();
+    if (position.latitude == 0 && position.longitude == 0) {
+        return false;
+    }
+
+    position.utcTime = "";
+    position.date = "";
+    position.epochMs = 0;
+    position.epochTicksUs = 0;
+    position.timeUncertaintyUs = 0;
+    position.hdop = 0;
+    position.altitude = 0;
+    position.fixMode = GNSS_FIX_NONE;
+    position.courseOverGround = 0;
+    position.speedKmh = 0;
+    position.speedKnots = 0;
+    position.numSatellites = 0;
+    position.source = POSITION_SOURCE_CELL;
+    position.accuracyMeters = cellAccuracyMeters;
+    position.valid = true;
+    return true;
+}
+
+bool QuectelEC200U::getServingCell(CellInfo& cell) {
+    cell.valid = false;
+    cell.lastError = 0;
+
+    String response;
+    int result = sendRawATCommand("AT+QENG=\"servingcell\"", response);
+    if (result != AT_OK) {
+        if (result <= AT_CME_ERROR) {
+            cell.lastError = AT_CME_ERROR - result;
+        }
+        return false;
+    }
+
+    // LTE: +QENG: "servingcell",<state>,"LTE",<is_tdd>,<mcc>,<mnc>,<cellid>,<pcid>,<earfcn>,
+    //             <band>,<ul_bw>,<dl_bw>,<tac>,<rsrp>,...
+    // GSM: +QENG: "servingcell",<state>,"GSM",<mcc>,<mnc>,<lac>,<cellid>,<bsic>,<arfcn>,<band>,<rxlev>,...
+    int idx = response.indexOf("+QENG: ");
+    if (idx < 0) return false;
+    idx += 7;
+    int endIdx = response.indexOf('\r', idx);
+    if (endIdx < 0) endIdx = response.length();
+
+    String fields[14];
+    int count = 0;
+    while (count < 14 && idx <= endIdx) {
+        int commaIdx = response.indexOf(',', idx);
+        if (commaIdx < 0 || commaIdx > endIdx) commaIdx = endIdx;
+        fields[count] = response.substring(idx, commaIdx);
+        fields[count].replace("\"", "");
+        fields[count].trim();
+        count++;
+        idx = commaIdx + 1;
+    }
+    if (count < 3) return false;
+
+    cell.rat = fields[2];
+    if (cell.rat == "LTE" && count >= 14) {
+        cell.mcc = fields[4].toInt();
+        cell.mnc = fields[5].toInt();
+        cell.cellId = strtoul(fields[6].c_str(), nullptr, 16);
+        cell.channel = fields[8].toInt();
+        cell.areaCode = strtoul(fields[12].c_str(), nullptr, 16);
+        cell.signalDbm = fields[13].toInt();
+    } else if (cell.rat == "GSM" && count >= 11) {
+        cell.mcc = fields[3].toInt();
+        cell.mnc = fields[4].toInt();
+        cell.areaCode = strtoul(fields[5].c_str(), nullptr, 16);
+        cell.cellId = strtoul(fields[6].c_str(), nullptr, 16);
+        cell.channel = fields[8].toInt();
+        cell.signalDbm = fields[10].toInt() - 111;  // rxlev 0..63 -> dBm
+    } else {
+        return false;  // Not registered ("SEARCH"/"LIMSRV") or unknown RAT
+    }
+
+    cell.valid = true;
+    return true;
+}
+
+bool QuectelEC200U::getCoordinates(double& latitude, double& longitude) {
+    GNSSPosition position;
+    if (getPosition(position, GNSS_FORMAT_DECIMAL_DEGREES)) {
+        latitude = position.latitude;
+        longitude = position.longitude;
+        return true;
     }
+    return false;
 }
 
-// ========== GNSS/GPS Functions ==========
+bool QuectelEC200U::isGNSSFixed() {
+    if (fixSeen && fixCacheWindowMs > 0 && millis() - lastFixTime < fixCacheWindowMs) {
+        return true;
+    }
 
-bool QuectelEC200U::gnssBegin() {
-    // Configure GNSS parameters if needed
-    return sendATCommand("AT+QGPSCFG=\"nmeasrc\",1");  // Enable NMEA output
-}
+    // Only the final result code matters here, the position is not parsed
+    String response;
+    int result = sendRawATCommand("AT+QGPSLOC=2", response, 5000);
+    if (result == AT_OK && response.indexOf("+QGPSLOC: ") >= 0) {
+        noteGNSSFix(millis());
+        return true;
+    }
 
-bool QuectelEC200U::gnssOn(int mode, int fixMaxTime) {
-    String cmd = "AT+QGPS=" + String(mode);
-    if (fixMaxTime != 30) {
-        cmd += "," + String(fixMaxTime);
+    if (result <= AT_CME_ERROR) {
+        fixSeen = false;
+        noteGNSSError(AT_CME_ERROR - result);
     }
-    return sendATCommand(cmd);
+    return false;
 }
 
-bool QuectelEC200U::gnssOff() {
-    return sendATCommand("AT+QGPSEND");
+unsigned long QuectelEC200U::getFixAge() {
+    if (!fixSeen) {
+        return ULONG_MAX;
+    }
+    return millis() - lastFixTime;
 }
 
-bool QuectelEC200U::getPosition(GNSSPosition& position, GNSSCoordFormat format,
-                                int maxRetries, unsigned long retryDelay) {
+bool QuectelEC200U::acquirePosition(GNSSPosition& position, float targetHdop,
+                                    unsigned long maxWaitMs, GNSSCoordFormat format) {
     position.valid = false;
+    position.source = POSITION_SOURCE_NONE;
     position.lastError = 0;
 
-    for (int retry = 0; retry < maxRetries; retry++) {
+    GNSSPosition candidate;
+    float lastHdop = 0;
+    unsigned long interval = acqMinPollMs;
+    unsigned long startTime = millis();
+
+    // Sky summary for the backoff; without an NMEA stream each refresh costs
+    // two AT+QGPSGNMEA round trips, so it is reused for up to acqMaxPollMs
+    GNSSSatelliteSummary sky;
+    sky.valid = false;
+    bool skyRead = false;
+    unsigned long skyTime = 0;
+
+    while (millis() - startTime < maxWaitMs) {
         String response;
         String cmd = "AT+QGPSLOC=" + String(format);
         int result = sendRawATCommand(cmd, response, 5000);
+        GNSSSatelliteSummary summary;
+        summary.valid = false;
 
-        if (result == AT_OK) {
-            if (parseGNSSResponse(response, position, format)) {
-                position.valid = true;
+        if (result == AT_OK && parseGNSSResponse(response, candidate, format)) {
+            noteGNSSFix(millis());
+            candidate.valid = true;
+            candidate.lastError = 0;
+
+            // Keep the best fix seen so far
+            if (!position.valid || candidate.hdop < position.hdop) {
+                position = candidate;
+            }
+            if (candidate.hdop > 0 && candidate.hdop <= targetHdop) {
+                processFix(position);
                 return true;
             }
+            interval = nextAcquisitionPoll(summary, lastHdop, candidate.hdop, interval);
+            lastHdop = candidate.hdop;
         } else if (result <= AT_CME_ERROR) {
             int cmeError = AT_CME_ERROR - result;
-            position.lastError = cmeError;
+            if (!position.valid) {
+                position.lastError = cmeError;
+            }
+            noteGNSSError(cmeError);
 
-            // Check if error is temporary (not fixed yet)
-            if (cmeError == CME_NOT_FIXED_NOW) {
-                DEBUG_PRINTLN("GNSS not fixed yet, retrying...");
-                delay(retryDelay);
-                continue;
-            } else if (cmeError == CME_SESSION_NOT_ACTIVE) {
-                DEBUG_PRINTLN("GNSS session not active, turning on GNSS...");
-                if (gnssOn()) {
-                    delay(2000);  // Give GNSS time to start
-                    continue;
+            if (cmeError == CME_SESSION_NOT_ACTIVE) {
+                QLOG_INFO("GNSS session not active, turning on GNSS...");
+                if (!gnssOn()) {
+                    break;
                 }
+                // Engine state is read back from GSV/GSA on the next pass
+                interval = acqMinPollMs;
+            } else if (cmeError == CME_NOT_FIXED_NOW) {
+                if (nmeaStream != nullptr) {
+                    // The stream keeps the parser's sky view current
+                    summarizeSkyView(sky);
+                } else if (!skyRead || millis() - skyTime >= acqMaxPollMs) {
+                    getSatelliteSummary(sky);
+                    skyRead = true;
+                    skyTime = millis();
+                }
+                interval = nextAcquisitionPoll(sky, lastHdop, 0, interval);
+            } else {
+                break;
             }
-            // For other errors, stop retrying
+        } else {
+            interval = nextAcquisitionPoll(summary, lastHdop, 0, interval);
+        }
+
+        unsigned long elapsed = millis() - startTime;
+        if (elapsed >= maxWaitMs) {
             break;
         }
+        serviceDelay(min(interval, maxWaitMs - elapsed));
+    }
 
-        delay(retryDelay);
+    if (position.valid) {
+        processFix(position);
     }
+    return position.valid;
+}
 
-    return false;
+void QuectelEC200U::processFix(GNSSPosition& position) {
+    unsigned long now = millis();
+    if (position.epochMs != 0 && position.epochTicksUs != 0) {
+        softClock.sync(position.epochMs, position.epochTicksUs, CLOCK_SOURCE_GNSS,
+                       position.timeUncertaintyUs);
+    }
+    if (positionFilter != nullptr) {
+        positionFilter->update(position, now);
+    }
+    if (reportFilter != nullptr) {
+        reportFilter->update(position, now);
+    }
+    if (geofenceEngine != nullptr) {
+        geofenceEngine->update(position, now);
+    }
+    if (trackSimplifier != nullptr) {
+        trackSimplifier->add(position, now);
+    }
 }
 
-bool QuectelEC200U::getCoordinates(double& latitude, double& longitude) {
-    GNSSPosition position;
-    if (getPosition(position, GNSS_FORMAT_DECIMAL_DEGREES)) {
-        latitude = position.latitude;
-        longitude = position.longitude;
-        return true;
+unsigned long QuectelEC200U::nextAcquisitionPoll(const GNSSSatelliteSummary& summary,
+                                                 float lastHdop, float hdop,
+                                                 unsigned long lastInterval) {
+    unsigned long midInterval = (acqMinPollMs + acqMaxPollMs) / 2;
+
+    if (hdop > 0) {
+        // Fixed but not yet accurate enough: poll fast while HDOP is still
+        // improving, back off once it has settled
+        if (lastHdop <= 0 || hdop < lastHdop * 0.9f) {
+            return acqMinPollMs;
+        }
+        return min(lastInterval + lastInterval / 2, midInterval);
     }
-    return false;
+
+    if (!summary.valid) {
+        // No sky data: plain exponential backoff
+        return min(lastInterval + lastInterval / 2, acqMaxPollMs);
+    }
+
+    if (summary.satellitesUsed >= 3) {
+        return acqMinPollMs;  // Fix is imminent
+    }
+    if (summary.satellitesInView == 0) {
+        return acqMaxPollMs;  // Still searching the sky
+    }
+
+    // Scale between max and min with the number of satellites being tracked
+    unsigned long inView = min((unsigned long)summary.satellitesInView, 8UL);
+    return acqMaxPollMs - ((acqMaxPollMs - acqMinPollMs) * inView) / 8;
 }
 
-bool QuectelEC200U::isGNSSFixed() {
-    GNSSPosition position;
-    // Try to get position with just 1 retry
-    return getPosition(position, GNSS_FORMAT_DECIMAL_DEGREES, 1, 100);
+bool QuectelEC200U::updateSkyView() {
+    String response;
+    if (sendRawATCommand("AT+QGPSGNMEA=\"GSV\"", response) != AT_OK) {
+        return false;
+    }
+    feedNMEA(response);
+
+    if (sendRawATCommand("AT+QGPSGNMEA=\"GSA\"", response) != AT_OK) {
+        return false;
+    }
+    feedNMEA(response);
+    return true;
+}
+
+bool QuectelEC200U::getSatelliteSummary(GNSSSatelliteSummary& summary) {
+    summary.valid = false;
+    summary.satellitesInView = 0;
+    summary.satellitesUsed = 0;
+    summary.pdop = 0;
+    summary.hdop = 0;
+
+    if (!updateSkyView()) {
+        return false;
+    }
+    summarizeSkyView(summary);
+    return true;
+}
+
+void QuectelEC200U::summarizeSkyView(GNSSSatelliteSummary& summary) {
+    const GNSSSkyView& sky = nmeaParser.getSkyView();
+    int inView = 0;
+    int used = 0;
+    for (int c = 0; c < GNSS_CONSTELLATION_COUNT; c++) {
+        inView += sky.constellations[c].inView;
+        used += sky.constellations[c].used;
+    }
+    summary.satellitesInView = (inView > 255) ? 255 : inView;
+    summary.satellitesUsed = (used > 255) ? 255 : used;
+    summary.pdop = sky.pdop;
+    summary.hdop = sky.hdop;
+    summary.valid = true;
+}
+
+void QuectelEC200U::feedNMEA(const String& response) {
+    // Each line: "+QGPSGNMEA: $xxYYY,...*hh"
+    const char* text = response.c_str();
+    int idx = response.indexOf('$');
+    while (idx >= 0) {
+        int endIdx = response.indexOf('\r', idx);
+        if (endIdx < 0) {
+            endIdx = response.length();
+        }
+        nmeaParser.parse(text + idx, endIdx - idx);
+        idx = response.indexOf('$', endIdx);
+    }
+}
+
+void QuectelEC200U::serviceNMEA() {
+    if (nmeaStream == nullptr) {
+        return;
+    }
+    int64_t nowUs = quectelTicksUs();
+    int pending = nmeaStream->available();
+    if (pending > 0) {
+        if (nmeaPollUs - nmeaLastByteUs > NMEA_BURST_GAP_US) {
+            // The port was idle at the previous poll, so an epoch's burst started
+            // after it and no later than if the waiting bytes arrived back to back
+            int64_t latestUs = nowUs - (int64_t)(pending - 1) * nmeaByteUs;
+            latestUs = max(latestUs, nmeaPollUs);
+            nmeaBurstUs = nmeaPollUs + (latestUs - nmeaPollUs) / 2;
+            nmeaBurstUncertaintyUs = (uint32_t)((latestUs - nmeaPollUs) / 2);
+        }
+        nmeaLastByteUs = nowUs;
+    }
+    while (pending > 0) {
+        char c = nmeaStream->read();
+        if (--pending == 0) {
+            pending = nmeaStream->available();
+        }
+        if (c == '$') {
+            nmeaLineLength = 0;  // Resync on every sentence start
+        } else if (nmeaLineLength == 0) {
+            continue;            // Skip until the next '$'
+        }
+        if (c == '\r' || c == '\n') {
+            handleNMEALine();
+            nmeaLineLength = 0;
+        } else if (nmeaLineLength < QUECTEL_NMEA_LINE_MAX) {
+            nmeaLine[nmeaLineLength++] = c;
+        } else {
+            nmeaLineLength = 0;  // Overlong, drop it
+        }
+    }
+    nmeaPollUs = quectelTicksUs();
+}
+
+void QuectelEC200U::handleNMEALine() {
+    if (!nmeaParser.parse(nmeaLine, nmeaLineLength) || memcmp(nmeaLine + 3, "RMC", 3) != 0) {
+        return;
+    }
+    const NMEAFix& fix = nmeaParser.getFix();
+    if (!fix.valid) {
+        return;
+    }
+
+    // RMC closes an epoch; GGA/GSA of the same epoch usually arrive first
+    GNSSPosition& position = nmeaPosition;
+    position.valid = true;
+    position.latitude = fix.latitude;
+    position.longitude = fix.longitude;
+    position.hdop = fix.hdop;
+    position.altitude = fix.altitude;
+    position.fixMode = (nmeaParser.getSkyView().fixType >= GNSS_FIX_2D) ? nmeaParser.getSkyView().fixType
+                                                                         : (uint8_t)GNSS_FIX_2D;
+    position.courseOverGround = fix.courseOverGround;
+    position.speedKnots = fix.speedKnots;
+    position.speedKmh = fix.speedKnots * 1.852f;
+    position.epochMs = fix.epochMs;
+    // The burst carrying this RMC started at the epoch plus the module's output latency
+    bool burstValid = nmeaBurstUs != 0 && nmeaLastByteUs - nmeaBurstUs < 1000000;
+    position.epochTicksUs = burstValid ? nmeaBurstUs - (int64_t)nmeaLatencyMs * 1000 : 0;
+    position.timeUncertaintyUs = nmeaBurstUncertaintyUs + NMEA_TIME_UNCERTAINTY_US;
+    position.numSatellites = fix.satellites;
+    position.source = POSITION_SOURCE_GNSS;
+    position.accuracyMeters = fix.hdop * GNSS_UERE_METERS;
+    position.lastError = 0;
+
+    nmeaPositionTime = fix.updated;
+    noteGNSSFix(fix.updated);
+    processFix(position);
+}
+
+bool QuectelEC200U::getNMEAPosition(GNSSPosition& position, unsigned long maxAgeMs) {
+    serviceNMEA();
+    if (!nmeaPosition.valid || millis() - nmeaPositionTime > maxAgeMs) {
+        return false;
+    }
+    position = nmeaPosition;
+    return true;
+}
+
+void QuectelEC200U::serviceDelay(unsigned long ms) {
+    if (nmeaStream == nullptr) {
+        delay(ms);
+        return;
+    }
+    // Short slices keep the NMEA UART's receive buffer from overflowing
+    unsigned long startTime = millis();
+    serviceNMEA();
+    while (millis() - startTime < ms) {
+        unsigned long remaining = ms - (millis() - startTime);
+        delay(remaining < 5 ? remaining : 5);
+        serviceNMEA();
+    }
 }
 
 bool QuectelEC200U::parseGNSSResponse(const String& response, GNSSPosition& position,
                                       GNSSCoordFormat format) {
     int idx = response.indexOf("+QGPSLOC: ");
     if (idx < 0) return false;
+    int lineIdx = idx;
 
     idx += 10;  // Skip "+QGPSLOC: "
 
@@ -347,6 +1504,17 @@ bool QuectelEC200U::parseGNSSResponse(const String& response, GNSSPosition& posi
     if (endIdx > idx) {
         position.numSatellites = response.substring(idx, endIdx).toInt();
     }
+    position.epochMs = quectelParseNMEATime(position.utcTime.c_str(), position.date.c_str());
+
+    // The reported fix was computed up to one fix period before the modem started
+    // sending; take the middle of that window and of readResponse()'s poll slice
+    int64_t fixPeriodUs = 1000000 / ((gnssConfig.fixRateHz > 0) ? gnssConfig.fixRateHz : 1);
+    int64_t sentUs = responseTicksUs - uartTransferUs(response.length() - lineIdx, baudRate) - 5000;
+    position.epochTicksUs = sentUs - fixPeriodUs / 2;
+    position.timeUncertaintyUs = (uint32_t)(fixPeriodUs / 2 + 5000);
+
+    position.source = POSITION_SOURCE_GNSS;
+    position.accuracyMeters = position.hdop * GNSS_UERE_METERS;
 
     return true;
 }
@@ -412,28 +1580,28 @@ bool QuectelEC200U::sslBegin(int contextID, int sslContextID, int sslVersion) {
     // Activate PDP context first
     String activateCmd = "AT+QIACT=" + String(contextID);
     if (!sendATCommand(activateCmd, 30000)) {  // 30s timeout for network activation
-        DEBUG_PRINTLN("Failed to activate PDP context");
+        QLOG_ERROR("Failed to activate PDP context");
         return false;
     }
 
     // Configure SSL version
     String configCmd = "AT+QSSLCFG=\"sslversion\"," + String(sslContextID) + "," + String(sslVersion);
     if (!sendATCommand(configCmd)) {
-        DEBUG_PRINTLN("Failed to configure SSL version");
+        QLOG_ERROR("Failed to configure SSL version");
         return false;
     }
 
     // Configure cipher suite (use all available)
     configCmd = "AT+QSSLCFG=\"ciphersuite\"," + String(sslContextID) + ",0xFFFF";
     if (!sendATCommand(configCmd)) {
-        DEBUG_PRINTLN("Failed to configure cipher suite");
+        QLOG_ERROR("Failed to configure cipher suite");
         return false;
     }
 
     // Configure negotiation time
     configCmd = "AT+QSSLCFG=\"negotiatetime\"," + String(sslContextID) + ",300";
     if (!sendATCommand(configCmd)) {
-        DEBUG_PRINTLN("Failed to configure negotiation time");
+        QLOG_ERROR("Failed to configure negotiation time");
         return false;
     }
 
@@ -472,9 +1640,12 @@ bool QuectelEC200U::httpsConnect(const String& serverAddress, int port,
     String cmd = "AT+QSSLOPEN=" + String(contextID) + "," + String(sslContextID) + "," +
                  String(clientID) + ",\"" + serverAddress + "\"," + String(port) + ",2";
 
+    if (failFast(cmd)) {
+        return false;
+    }
     clearBuffer();
-    DEBUG_PRINT(">> ");
-    DEBUG_PRINTLN(cmd);
+    traceCommand(cmd);
+    beginStatus(cmd);
     modemSerial->println(cmd);
 
     // Wait for CONNECT response (up to 150s + negotiation time)
@@ -488,39 +1659,42 @@ bool QuectelEC200U::httpsConnect(const String& serverAddress, int port,
             response += c;
 
             if (response.indexOf("CONNECT") >= 0) {
-                DEBUG_PRINTLN("<< CONNECT");
+                traceResponse(response);
+                endStatus(AT_CONNECT, 0, response.length());
                 state.connected = true;
                 transparentMode = true;
                 currentSSLClient = clientID;
                 return true;
             }
 
-            if (response.indexOf("ERROR") >= 0) {
-                DEBUG_PRINT("<< ");
-                DEBUG_PRINTLN(response);
+            // Wait for the line end so the CME/SSL code is complete
+            if (response.indexOf("ERROR") >= 0 && response.endsWith("\r\n")) {
+                traceResponse(response);
+                endStatus(parseATResponse(response), 0, response.length());
                 return false;
             }
 
-            if (response.indexOf("+QSSLOPEN:") >= 0) {
+            if (response.indexOf("+QSSLOPEN:") >= 0 && response.endsWith("\r\n")) {
                 // Parse SSL error
                 int commaIdx = response.indexOf(',');
                 if (commaIdx > 0) {
                     state.sslError = response.substring(commaIdx + 1).toInt();
                 }
-                DEBUG_PRINT("<< SSL Error: ");
-                DEBUG_PRINTLN(state.sslError);
+                traceResponse(response);
+                endStatus(AT_ERROR, state.sslError, response.length());
                 return false;
             }
         }
-        delay(10);
+        serviceDelay(10);
     }
 
+    endStatus(AT_TIMEOUT, 0, response.length());
     return false;
 }
 
 bool QuectelEC200U::httpsSend(const String& data) {
     if (!transparentMode) {
-        DEBUG_PRINTLN("Not in transparent mode");
+        QLOG_WARN("Not in transparent mode");
         return false;
     }
 
@@ -530,7 +1704,7 @@ bool QuectelEC200U::httpsSend(const String& data) {
 
 bool QuectelEC200U::httpsSendBytes(const uint8_t* data, size_t length) {
     if (!transparentMode) {
-        DEBUG_PRINTLN("Not in transparent mode");
+        QLOG_WARN("Not in transparent mode");
         return false;
     }
 
@@ -624,13 +1798,13 @@ bool QuectelEC200U::exitTransparentMode() {
     }
 
     // Wait 1 second of no data
-    delay(1000);
+    serviceDelay(1000);
 
     // Send +++ escape sequence
     modemSerial->print("+++");
 
     // Wait 1 second after
-    delay(1000);
+    serviceDelay(1000);
 
     // Check for OK response
     String response = readResponse(2000);
@@ -646,7 +1820,7 @@ bool QuectelEC200U::httpsDisconnect(int clientID) {
     // Exit transparent mode first if needed
     if (transparentMode && clientID == currentSSLClient) {
         if (!exitTransparentMode()) {
-            DEBUG_PRINTLN("Failed to exit transparent mode");
+            QLOG_WARN("Failed to exit transparent mode");
         }
     }
 
@@ -706,7 +1880,7 @@ bool QuectelEC200U::httpsGET(const String& host, const String& path, String& res
                 }
             }
         }
-        delay(100);
+        serviceDelay(100);
     }
 
     return (response.length() > 0);
@@ -761,7 +1935,7 @@ bool QuectelEC200U::httpsPOST(const String& host, const String& path,
                 }
             }
         }
-        delay(100);
+        serviceDelay(100);
     }
 
     return (response.length() > 0);
@@ -769,6 +1943,67 @@ bool QuectelEC200U::httpsPOST(const String& host, const String& path,
 
 // ========== Time Functions ==========
 
+// Two ASCII digits at p, or -1
+static int parseTimeDigits(const char* p) {
+    if (p[0] < '0' || p[0] > '9' || p[1] < '0' || p[1] > '9') {
+        return -1;
+    }
+    return (p[0] - '0') * 10 + (p[1] - '0');
+}
+
+// Parse "[YY]YY/MM/dd,hh:mm:ss[±zz[,d]]" at fixed offsets; yearDigits is 4 (+QLTS) or 2 (+CCLK)
+static bool parseTimeString(const char* text, size_t length, int yearDigits,
+                            bool localTime, NetworkTime& time) {
+    size_t base = yearDigits - 2;  // Field offsets after the year
+    if (length < base + 17) {
+        return false;
+    }
+
+    int century = (yearDigits == 4) ? parseTimeDigits(text) : 20;
+    int year = parseTimeDigits(text + base);
+    int month = parseTimeDigits(text + base + 3);
+    int day = parseTimeDigits(text + base + 6);
+    int hour = parseTimeDigits(text + base + 9);
+    int minute = parseTimeDigits(text + base + 12);
+    int second = parseTimeDigits(text + base + 15);
+    if (century < 0 || year < 0 || month < 1 || month > 12 || day < 1 || day > 31 ||
+        hour < 0 || hour > 23 || minute < 0 || minute > 59 || second < 0 || second > 60) {
+        return false;
+    }
+
+    // Zone: sign and one or two digits, quarters of an hour
+    int timezone = 0;
+    size_t idx = base + 17;
+    if (idx < length && (text[idx] == '+' || text[idx] == '-')) {
+        bool negative = (text[idx] == '-');
+        idx++;
+        while (idx < length && text[idx] >= '0' && text[idx] <= '9') {
+            timezone = timezone * 10 + (text[idx] - '0');
+            idx++;
+        }
+        timezone = negative ? -timezone : timezone;
+    }
+
+    time.year = century * 100 + year;
+    time.month = month;
+    time.day = day;
+    time.hour = hour;
+    time.minute = minute;
+    time.second = second;
+    time.timezone = timezone;
+    time.timezoneHours = timezone / 4;  // Convert quarters to hours
+    time.daylightSaving = (idx + 1 < length && text[idx] == ',' && text[idx + 1] == '1');
+    time.epochMs = localTime
+        ? quectelZonedEpochMs(time.year, month, day, hour, minute, second, timezone)
+        : quectelEpochMs(time.year, month, day, hour, minute, second);
+
+    size_t copyLength = (length < NETWORK_TIME_STR_LEN) ? length : NETWORK_TIME_STR_LEN - 1;
+    memcpy(time.dateTime, text, copyLength);
+    time.dateTime[copyLength] = '\0';
+    time.valid = true;
+    return true;
+}
+
 bool QuectelEC200U::getNetworkTime(NetworkTime& time, TimeQueryMode mode) {
     time.valid = false;
     time.lastError = 0;
@@ -778,7 +2013,15 @@ bool QuectelEC200U::getNetworkTime(NetworkTime& time, TimeQueryMode mode) {
     int result = sendRawATCommand(cmd, response);
 
     if (result == AT_OK) {
-        return parseNetworkTime(response, time);
+        if (!parseNetworkTime(response, time, mode == TIME_MODE_LOCAL)) {
+            return false;
+        }
+        // Last-sync mode reports when NITZ arrived, not the current time
+        if (mode != TIME_MODE_LAST_SYNC) {
+            updateTimeZone(time.timezone, time.daylightSaving);
+            softClock.sync(time.epochMs, responseTicksUs, CLOCK_SOURCE_NITZ);
+        }
+        return true;
     } else if (result <= AT_CME_ERROR) {
         time.lastError = AT_CME_ERROR - result;
     }
@@ -818,36 +2061,19 @@ bool QuectelEC200U::setRTCTime(int year, int month, int day,
 
 bool QuectelEC200U::getRTCTime(NetworkTime& time) {
     time.valid = false;
+    time.lastError = 0;
 
     String response;
     if (sendRawATCommand("AT+CCLK?", response) == AT_OK) {
+        // +CCLK: "yy/MM/dd,hh:mm:ss±zz" (local time)
         int idx = response.indexOf("+CCLK: \"");
         if (idx >= 0) {
             idx += 8;
             int endIdx = response.indexOf('\"', idx);
-            if (endIdx > idx) {
-                String timeStr = response.substring(idx, endIdx);
-                time.dateTime = timeStr;
-
-                // Parse the time string
-                // Format: "yy/MM/dd,hh:mm:ss±zz"
-                if (timeStr.length() >= 17) {
-                    time.year = 2000 + timeStr.substring(0, 2).toInt();
-                    time.month = timeStr.substring(3, 5).toInt();
-                    time.day = timeStr.substring(6, 8).toInt();
-                    time.hour = timeStr.substring(9, 11).toInt();
-                    time.minute = timeStr.substring(12, 14).toInt();
-                    time.second = timeStr.substring(15, 17).toInt();
-
-                    if (timeStr.length() >= 20) {
-                        String tzStr = timeStr.substring(17);
-                        time.timezone = tzStr.toInt();
-                        time.timezoneHours = time.timezone / 4;  // Convert quarters to hours
-                    }
-
-                    time.valid = true;
-                    return true;
-                }
+            if (endIdx > idx &&
+                parseTimeString(response.c_str() + idx, endIdx - idx, 2, true, time)) {
+                softClock.sync(time.epochMs, responseTicksUs, CLOCK_SOURCE_RTC);
+                return true;
             }
         }
     }
@@ -867,7 +2093,250 @@ bool QuectelEC200U::syncTimeFromNetwork() {
     return false;
 }
 
-bool QuectelEC200U::parseNetworkTime(const String& response, NetworkTime& time) {
+bool QuectelEC200U::syncTimeNTP(const String& server, NTPResult& result, int samples,
+                                int contextID, int port, unsigned long timeoutMs) {
+    result.valid = false;
+    result.samples = 0;
+    result.epochMs = 0;
+    result.offsetMs = 0;
+    result.rttMs = 0;
+    result.uncertaintyMs = 0;
+    result.lastError = 0;
+    samples = constrain(samples, 1, 8);
+
+    String cmd = "AT+QNTP=" + String(contextID) + ",\"" + server + "\"," + String(port);
+
+    // UTC minus local ticks lies in [lo, hi] (µs)
+    int64_t lo = 0;
+    int64_t hi = 0;
+    int64_t lastReceivedUs = 0;
+    for (int i = 0; i < samples; i++) {
+        NetworkTime time;
+        int64_t sentUs = 0;
+        int64_t receivedUs = 0;
+        int error = queryNTP(cmd, timeoutMs, time, sentUs, receivedUs);
+        if (error != 0) {
+            result.lastError = error;
+            break;
+        }
+
+        uint32_t rttMs = (uint32_t)((receivedUs - sentUs) / 1000);
+        if (result.samples == 0 || rttMs < result.rttMs) {
+            result.rttMs = rttMs;
+        }
+
+        // The reported second was current at some point between send and receive
+        int64_t secondUs = (int64_t)time.epochMs * 1000;
+        int64_t sampleLo = secondUs - receivedUs;
+        int64_t sampleHi = secondUs + 1000000 - sentUs;
+        if (result.samples > 0 && sampleLo <= hi && sampleHi >= lo) {
+            lo = max(lo, sampleLo);
+            hi = min(hi, sampleHi);
+        } else {
+            if (result.samples > 0) {
+                QLOG_WARN("NTP sample inconsistent, restarting estimate");
+            }
+            lo = sampleLo;
+            hi = sampleHi;
+            result.samples = 0;
+        }
+        result.samples++;
+        lastReceivedUs = receivedUs;
+
+        // Time the next query so the estimated second boundary falls mid-exchange
+        if (i + 1 < samples) {
+            int64_t phase = (quectelTicksUs() + (receivedUs - sentUs) / 2 + lo + (hi - lo) / 2) % 1000000;
+            if (phase < 0) {
+                phase += 1000000;
+            }
+            serviceDelay((unsigned long)((1000000 - phase) / 1000));
+        }
+    }
+
+    if (result.samples == 0) {
+        return false;
+    }
+
+    int64_t offsetUs = lo + (hi - lo) / 2;
+    result.epochMs = (uint64_t)((lastReceivedUs + offsetUs) / 1000);
+    result.uncertaintyMs = (uint32_t)((hi - lo) / 2000);
+    if (softClock.isSynced()) {
+        result.offsetMs = (int32_t)((int64_t)result.epochMs -
+                                    (int64_t)softClock.ticksToEpochMs(lastReceivedUs));
+    }
+    softClock.sync(result.epochMs, lastReceivedUs, CLOCK_SOURCE_NTP, result.uncertaintyMs * 1000 + 500);
+    ntpServer = server;
+    result.valid = true;
+    return true;
+}
+
+int QuectelEC200U::queryNTP(const String& command, unsigned long timeoutMs, NetworkTime& time,
+                            int64_t& sentUs, int64_t& receivedUs) {
+    if (failFast(command)) {
+        return -1;
+    }
+    clearBuffer();
+
+    traceCommand(command);
+
+    beginStatus(command);
+    modemSerial->println(command);
+    sentUs = quectelTicksUs();
+
+    // OK arrives first, +QNTP: <err>[,"YYYY/MM/dd,hh:mm:ss±zz"] once the server answered
+    unsigned long startTime = millis();
+    String response = "";
+    int urcIdx = -1;
+    while (millis() - startTime < timeoutMs) {
+        while (modemSerial->available()) {
+            response += (char)modemSerial->read();
+            if (urcIdx < 0) {
+                urcIdx = response.indexOf("+QNTP: ");
+                if (urcIdx >= 0) {
+                    receivedUs = quectelTicksUs();
+                }
+            }
+        }
+
+        if (urcIdx >= 0 && response.indexOf("\r\n", urcIdx) > 0) {
+            traceResponse(response);
+
+            int error = atoi(response.c_str() + urcIdx + 7);
+            endStatus(error == 0 ? AT_OK : AT_ERROR, error, response.length());
+            if (error != 0) {
+                return error;
+            }
+            int quoteIdx = response.indexOf('\"', urcIdx);
+            int endIdx = (quoteIdx > 0) ? response.indexOf('\"', quoteIdx + 1) : -1;
+            if (endIdx <= quoteIdx + 1 ||
+                !parseTimeString(response.c_str() + quoteIdx + 1, endIdx - quoteIdx - 1, 4, true, time)) {
+                return -1;
+            }
+            return 0;
+        }
+
+        if (urcIdx < 0 && response.indexOf("ERROR") >= 0 && response.endsWith("\r\n")) {
+            traceResponse(response);
+            int result = endStatus(parseATResponse(response), 0, response.length());
+            return (result <= AT_CME_ERROR) ? AT_CME_ERROR - result : -1;
+        }
+        serviceDelay(1);
+    }
+
+    endStatus(AT_TIMEOUT, 0, response.length());
+    return -1;
+}
+
+bool QuectelEC200U::setTimeZoneReporting(bool enable) {
+    // 2 = +CTZE with zone, DST and local time
+    if (!sendATCommand(enable ? "AT+CTZR=2" : "AT+CTZR=0")) {
+        // Older firmware only reports the zone (+CTZV)
+        if (!enable || !sendATCommand("AT+CTZR=1")) {
+            return false;
+        }
+    }
+    timeZoneReports = enable;
+    return true;
+}
+
+void QuectelEC200U::processURCs() {
+    while (modemSerial->available()) {
+        char c = modemSerial->read();
+        if (c == '\r' || c == '\n') {
+            if (urcLineLength > 0) {
+                handleURC(urcLine, urcLineLength);
+            }
+            urcLineLength = 0;
+        } else if (urcLineLength < QUECTEL_URC_LINE_MAX) {
+            urcLine[urcLineLength++] = c;
+        } else {
+            urcLineLength = 0;  // Overlong, drop it
+        }
+    }
+}
+
+void QuectelEC200U::handleResponseURCs(const String& response) {
+    // Zone reports can arrive in the middle of a command's response
+    if (!timeZoneReports) {
+        return;
+    }
+    const char* text = response.c_str();
+    int idx = response.indexOf("+CTZ");
+    while (idx >= 0) {
+        int endIdx = response.indexOf('\r', idx);
+        if (endIdx < 0) {
+            endIdx = response.length();
+        }
+        handleURC(text + idx, endIdx - idx);
+        idx = response.indexOf("+CTZ", endIdx);
+    }
+}
+
+// Signed integer field of an unterminated line, optionally quoted
+static int parseURCInt(const char* p, const char* end) {
+    if (p < end && *p == '\"') {
+        p++;
+    }
+    bool negative = (p < end && *p == '-');
+    if (p < end && (*p == '-' || *p == '+')) {
+        p++;
+    }
+    int value = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        value = value * 10 + (*p - '0');
+        p++;
+    }
+    return negative ? -value : value;
+}
+
+void QuectelEC200U::handleURC(const char* line, size_t length) {
+#if QUECTEL_TRACE
+    trace.record(TRACE_URC, line, length);
+#endif
+    if (length > 7 && memcmp(line, "+CTZV: ", 7) == 0) {
+        // +CTZV: <tz>, quoted on some firmware
+        updateTimeZone(parseURCInt(line + 7, line + length), daylightSaving);
+    } else if (length > 7 && memcmp(line, "+CTZE: ", 7) == 0) {
+        // +CTZE: "<tz>",<dst>,"yyyy/MM/dd,hh:mm:ss" (local time)
+        const char* p = line + 7;
+        const char* end = line + length;
+        int timezone = parseURCInt(p, end);
+        const char* comma = (const char*)memchr(p, ',', end - p);
+        bool dst = (comma != nullptr && parseURCInt(comma + 1, end) > 0);
+        updateTimeZone(timezone, dst);
+
+        const char* quote = (comma != nullptr) ? (const char*)memchr(comma + 1, '\"', end - comma - 1) : nullptr;
+        if (quote != nullptr) {
+            const char* closing = (const char*)memchr(quote + 1, '\"', end - quote - 1);
+            NetworkTime time;
+            if (closing != nullptr && parseTimeString(quote + 1, closing - quote - 1, 4, false, time)) {
+                softClock.sync(quectelZonedEpochMs(time.year, time.month, time.day, time.hour,
+                                                   time.minute, time.second, timezone),
+                               quectelTicksUs(), CLOCK_SOURCE_NITZ);
+            }
+        }
+    } else if (length > 8 && memcmp(line, "+QLTS: \"", 8) == 0) {
+        // Unsolicited +QLTS: "YYYY/MM/dd,hh:mm:ss±zz,d" (local time)
+        const char* closing = (const char*)memchr(line + 8, '\"', length - 8);
+        NetworkTime time;
+        if (closing != nullptr && parseTimeString(line + 8, closing - line - 8, 4, true, time)) {
+            updateTimeZone(time.timezone, time.daylightSaving);
+            softClock.sync(time.epochMs, quectelTicksUs(), CLOCK_SOURCE_NITZ);
+        }
+    }
+}
+
+void QuectelEC200U::updateTimeZone(int timezone, bool dst) {
+    bool changed = (timezone != softClock.getTimezone() || dst != daylightSaving);
+    softClock.setTimezone(timezone);
+    daylightSaving = dst;
+    if (changed && timeZoneCallback != nullptr) {
+        timeZoneCallback(timezone, dst, timeZoneContext);
+    }
+}
+
+bool QuectelEC200U::parseNetworkTime(const String& response, NetworkTime& time, bool localTime) {
+    // +QLTS: "YYYY/MM/dd,hh:mm:ss±zz,d"
     int idx = response.indexOf("+QLTS: \"");
     if (idx < 0) return false;
 
@@ -875,84 +2344,207 @@ bool QuectelEC200U::parseNetworkTime(const String& response, NetworkTime& time)
     int endIdx = response.indexOf('\"', idx);
     if (endIdx <= idx) {
         // Empty response means never synchronized
-        time.dateTime = "";
+        time.dateTime[0] = '\0';
         return false;
     }
 
-    time.dateTime = response.substring(idx, endIdx);
+    return parseTimeString(response.c_str() + idx, endIdx - idx, 4, localTime, time);
+}
+
+// ========== Local Clock ==========
+
+bool QuectelEC200U::syncClock() {
+    NetworkTime time;
+    // GMT mode: the time fields are UTC, the zone is still reported
+    if (getNetworkTime(time, TIME_MODE_GMT)) {
+        return true;
+    }
+    return getRTCTime(time);
+}
+
+bool QuectelEC200U::clockService() {
+    if (softClock.needsResync()) {
+        syncClock();
+    }
+    return softClock.isSynced();
+}
 
-    // Parse: "YYYY/MM/dd,hh:mm:ss±zz,d"
-    if (time.dateTime.length() >= 22) {
-        time.year = time.dateTime.substring(0, 4).toInt();
-        time.month = time.dateTime.substring(5, 7).toInt();
-        time.day = time.dateTime.substring(8, 10).toInt();
-        time.hour = time.dateTime.substring(11, 13).toInt();
-        time.minute = time.dateTime.substring(14, 16).toInt();
-        time.second = time.dateTime.substring(17, 19).toInt();
+bool QuectelEC200U::getClockTime(NetworkTime& time, bool local) {
+    time.valid = false;
+    time.lastError = 0;
+    if (!softClock.isSynced()) {
+        return false;
+    }
 
-        // Parse timezone
-        String tzStr = time.dateTime.substring(19, 22);
-        time.timezone = tzStr.toInt();
-        time.timezoneHours = time.timezone / 4;  // Convert quarters to hours
+    int timezone = local ? softClock.getTimezone() : 0;
+    int64_t epochMs = (int64_t)softClock.nowMs() + (int64_t)timezone * 15 * 60 * 1000;
+    int64_t seconds = epochMs / 1000;
+    int32_t days = (int32_t)(seconds / 86400);
+    int32_t secondOfDay = (int32_t)(seconds % 86400);
+
+    quectelCivilFromDays(days, time.year, time.month, time.day);
+    time.hour = secondOfDay / 3600;
+    time.minute = (secondOfDay / 60) % 60;
+    time.second = secondOfDay % 60;
+    time.timezone = timezone;
+    time.timezoneHours = timezone / 4;
+    time.daylightSaving = local && daylightSaving;
+    time.epochMs = softClock.nowMs();
+    time.dateTime[0] = '\0';
+    time.valid = true;
+    return true;
+}
 
-        // Parse DST if present
-        if (time.dateTime.length() >= 24) {
-            time.daylightSaving = (time.dateTime.charAt(23) == '1');
-        }
+bool QuectelEC200U::getBestTime(TimeEstimate& time, unsigned long maxAgeMs) {
+    serviceNMEA();
 
-        time.valid = true;
-        return true;
+    // Refresh from the most accurate source that answers; a worse source is
+    // ignored by the clock unless its resync interval has passed
+    if (softClock.getAgeMs() > maxAgeMs && gnssState != GNSS_STATE_OFF) {
+        GNSSPosition position;
+        getPosition(position, GNSS_FORMAT_DECIMAL_DEGREES, 1, 0);
+    }
+    if (softClock.getAgeMs() > maxAgeMs && ntpServer.length() > 0) {
+        NTPResult ntp;
+        syncTimeNTP(ntpServer, ntp, 1, 1, 123, BEST_TIME_NTP_TIMEOUT_MS);
+    }
+    if (softClock.getAgeMs() > maxAgeMs) {
+        NetworkTime network;
+        if (!getNetworkTime(network, TIME_MODE_GMT)) {
+            getRTCTime(network);
+        }
     }
 
-    return false;
+    time.valid = softClock.isSynced();
+    time.epochMs = softClock.nowMs();
+    time.source = softClock.getSource();
+    time.uncertaintyMs = softClock.getUncertaintyUs() / 1000;
+    time.ageMs = softClock.getAgeMs();
+    return time.valid && time.ageMs <= maxAgeMs;
 }
 
 // ========== Error Handling ==========
 
-String QuectelEC200U::getErrorDescription(int errorCode) {
-    if (errorCode == AT_OK) return "OK";
-    if (errorCode == AT_ERROR) return "ERROR";
-    if (errorCode == AT_TIMEOUT) return "Timeout";
-    if (errorCode == AT_CONNECT) return "Connected";
-    if (errorCode == AT_NO_CARRIER) return "No carrier";
-    if (errorCode == AT_SEND_OK) return "Send OK";
-    if (errorCode == AT_SEND_FAIL) return "Send failed";
+// Error code and description; the tables below are const, so they stay in flash
+struct ErrorDescription {
+    int code;
+    const char* text;
+};
+
+static constexpr ErrorDescription atErrorTable[] = {
+    { AT_SEND_FAIL, "Send failed" },
+    { AT_SEND_OK, "Send OK" },
+    { AT_NO_CARRIER, "No carrier" },
+    { AT_CONNECT, "Connected" },
+    { AT_TIMEOUT, "Timeout" },
+    { AT_ERROR, "ERROR" },
+    { AT_OK, "OK" }
+};
+
+// Indexed by CMEErrorCode, not by the AT_CME_ERROR - code form
+static constexpr ErrorDescription cmeErrorTable[] = {
+    { CME_PHONE_FAILURE, "Phone failure" },
+    { CME_NO_CONNECTION, "No connection to phone" },
+    { CME_LINK_RESERVED, "Phone adaptor link reserved" },
+    { CME_NOT_ALLOWED, "Operation not allowed" },
+    { CME_NOT_SUPPORTED, "Operation not supported" },
+    { CME_PH_SIM_PIN_REQUIRED, "PH-SIM PIN required" },
+    { CME_SIM_NOT_INSERTED, "SIM not inserted" },
+    { CME_SIM_PIN_REQUIRED, "SIM PIN required" },
+    { CME_SIM_PUK_REQUIRED, "SIM PUK required" },
+    { CME_SIM_FAILURE, "SIM failure" },
+    { CME_SIM_BUSY, "SIM busy" },
+    { CME_SIM_WRONG, "SIM wrong" },
+    { CME_INCORRECT_PASSWORD, "Incorrect password" },
+    { CME_MEMORY_FULL, "Memory full" },
+    { CME_INVALID_INDEX, "Invalid index" },
+    { CME_NOT_FOUND, "Not found" },
+    { CME_INVALID_PARAMS, "Invalid parameters" },
+    { CME_OP_NOT_SUPPORTED, "GNSS operation not supported" },
+    { CME_GNSS_BUSY, "GNSS subsystem busy" },
+    { CME_SESSION_ONGOING, "GNSS session ongoing" },
+    { CME_SESSION_NOT_ACTIVE, "GNSS session not active" },
+    { CME_OP_TIMEOUT, "Operation timeout" },
+    { CME_FUNC_NOT_ENABLED, "Function not enabled" },
+    { CME_TIME_INFO_ERROR, "Time information error" },
+    { CME_VALIDITY_OUT_RANGE, "Validity time out of range" },
+    { CME_INTERNAL_RES_ERROR, "Internal resource error" },
+    { CME_GNSS_LOCKED, "GNSS locked" },
+    { CME_END_BY_E911, "Session ended by E911" },
+    { CME_NOT_FIXED_NOW, "GNSS not fixed now" },
+    { CME_CMUX_NOT_OPENED, "CMUX port not opened" }
+};
+
+static constexpr ErrorDescription sslErrorTable[] = {
+    { SSL_UNKNOWN_ERROR, "SSL unknown error" },
+    { SSL_OP_BLOCKED, "SSL operation blocked" },
+    { SSL_INVALID_PARAM, "SSL invalid parameter" },
+    { SSL_MEMORY_NOT_ENOUGH, "SSL memory not enough" },
+    { SSL_CREATE_SOCKET_FAILED, "SSL create socket failed" },
+    { SSL_OP_NOT_SUPPORTED, "SSL operation not supported" },
+    { SSL_SOCKET_BIND_FAILED, "SSL socket bind failed" },
+    { SSL_SOCKET_LISTEN_FAILED, "SSL socket listen failed" },
+    { SSL_SOCKET_WRITE_FAILED, "SSL socket write failed" },
+    { SSL_SOCKET_READ_FAILED, "SSL socket read failed" },
+    { SSL_SOCKET_ACCEPT_FAILED, "SSL socket accept failed" },
+    { SSL_OPEN_PDP_FAILED, "SSL open PDP context failed" },
+    { SSL_CLOSE_PDP_FAILED, "SSL close PDP context failed" },
+    { SSL_SOCKET_ID_USED, "SSL socket ID already used" },
+    { SSL_DNS_BUSY, "SSL DNS busy" },
+    { SSL_DNS_PARSE_FAILED, "SSL DNS parse failed" },
+    { SSL_SOCKET_CONN_FAILED, "SSL connection failed" },
+    { SSL_SOCKET_CLOSED, "SSL socket closed" },
+    { SSL_OP_BUSY, "SSL operation busy" },
+    { SSL_OP_TIMEOUT, "SSL operation timeout" },
+    { SSL_PDP_BROKEN, "SSL PDP context broken" },
+    { SSL_CANCEL_SEND, "SSL send cancelled" },
+    { SSL_OP_NOT_ALLOWED, "SSL operation not allowed" },
+    { SSL_APN_NOT_CONFIGURED, "SSL APN not configured" },
+    { SSL_PORT_BUSY, "SSL port busy" },
+    { SSL_HANDSHAKE_FAIL, "SSL handshake failed" }
+};
+
+template <size_t N>
+constexpr bool errorTableSorted(const ErrorDescription (&table)[N], size_t i = 1) {
+    return i >= N || (table[i - 1].code < table[i].code && errorTableSorted(table, i + 1));
+}
+
+static_assert(errorTableSorted(atErrorTable), "atErrorTable must be sorted by code");
+static_assert(errorTableSorted(cmeErrorTable), "cmeErrorTable must be sorted by code");
+static_assert(errorTableSorted(sslErrorTable), "sslErrorTable must be sorted by code");
+
+template <size_t N>
+static const char* findErrorDescription(const ErrorDescription (&table)[N], int code) {
+    size_t lo = 0;
+    size_t hi = N;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (table[mid].code < code) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return (lo < N && table[lo].code == code) ? table[lo].text : nullptr;
+}
 
+const char* QuectelEC200U::getErrorDescription(int errorCode) {
+    const char* text;
     if (errorCode <= AT_CME_ERROR) {
-        int cmeError = AT_CME_ERROR - errorCode;
-        switch (cmeError) {
-            case CME_PHONE_FAILURE: return "Phone failure";
-            case CME_NO_CONNECTION: return "No connection to phone";
-            case CME_NOT_ALLOWED: return "Operation not allowed";
-            case CME_NOT_SUPPORTED: return "Operation not supported";
-            case CME_SIM_NOT_INSERTED: return "SIM not inserted";
-            case CME_SIM_PIN_REQUIRED: return "SIM PIN required";
-            case CME_SIM_FAILURE: return "SIM failure";
-            case CME_SIM_BUSY: return "SIM busy";
-            case CME_MEMORY_FULL: return "Memory full";
-            case CME_INVALID_PARAMS: return "Invalid parameters";
-            case CME_GNSS_BUSY: return "GNSS subsystem busy";
-            case CME_SESSION_NOT_ACTIVE: return "GNSS session not active";
-            case CME_OP_TIMEOUT: return "Operation timeout";
-            case CME_NOT_FIXED_NOW: return "GNSS not fixed now";
-            default: return "CME Error " + String(cmeError);
-        }
-    }
-
-    // SSL errors
-    switch (errorCode) {
-        case SSL_UNKNOWN_ERROR: return "SSL unknown error";
-        case SSL_OP_BLOCKED: return "SSL operation blocked";
-        case SSL_INVALID_PARAM: return "SSL invalid parameter";
-        case SSL_MEMORY_NOT_ENOUGH: return "SSL memory not enough";
-        case SSL_CREATE_SOCKET_FAILED: return "SSL create socket failed";
-        case SSL_DNS_PARSE_FAILED: return "SSL DNS parse failed";
-        case SSL_SOCKET_CONN_FAILED: return "SSL connection failed";
-        case SSL_SOCKET_CLOSED: return "SSL socket closed";
-        case SSL_OP_TIMEOUT: return "SSL operation timeout";
-        case SSL_HANDSHAKE_FAIL: return "SSL handshake failed";
-        default: return "Unknown error " + String(errorCode);
+        text = findErrorDescription(cmeErrorTable, AT_CME_ERROR - errorCode);
+        return text ? text : "Unknown CME error";
+    }
+    if (errorCode <= AT_OK) {
+        text = findErrorDescription(atErrorTable, errorCode);
+        return text ? text : "Unknown error";
     }
+
+    // Positive codes: SSL/TCP stack errors, or a raw CME code such as GNSSPosition::lastError
+    text = findErrorDescription(sslErrorTable, errorCode);
+    if (text == nullptr) {
+        text = findErrorDescription(cmeErrorTable, errorCode);
+    }
+    return text ? text : "Unknown error";
 }
 
 int QuectelEC200U::getLastSSLError() {
@@ -972,18 +2564,22 @@ int QuectelEC200U::getLastSSLError() {
 }
 
 int QuectelEC200U::sendRawATCommand(const String& command, String& response, unsigned long customTimeout) {
+    if (failFast(command)) {
+        response = "";
+        return AT_TIMEOUT;
+    }
     clearBuffer();
 
-    DEBUG_PRINT(">> ");
-    DEBUG_PRINTLN(command);
+    traceCommand(command);
 
+    beginStatus(command);
     modemSerial->println(command);
 
     unsigned long timeoutMs = (customTimeout > 0) ? customTimeout : timeout;
     response = readResponse(timeoutMs);
+    int result = endStatus(parseATResponse(response), 0, response.length());
 
-    DEBUG_PRINT("<< ");
-    DEBUG_PRINTLN(response);
+    traceResponse(response);
 
-    return parseATResponse(response);
+    return result;
 }
\ No newline at end of file
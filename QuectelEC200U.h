@@ -15,18 +15,32 @@
 
 #include <Arduino.h>
 #include <HardwareSerial.h>
+#include "NMEAParser.h"
+#include "QuectelTime.h"
+#include "QuectelMetrics.h"
+#include "QuectelTrace.h"
+#include "QuectelLog.h"
 
-// Debug output control
-#define QUECTEL_DEBUG 1
+// Longest NMEA sentence accepted from the NMEA stream (NMEA 0183 allows 82)
+#ifndef QUECTEL_NMEA_LINE_MAX
+#define QUECTEL_NMEA_LINE_MAX 96
+#endif
+
+// Characters of the failing command kept in QuectelStatus
+#ifndef QUECTEL_STATUS_CMD_LEN
+#define QUECTEL_STATUS_CMD_LEN 32
+#endif
 
-#if QUECTEL_DEBUG
-#define DEBUG_PRINT(x) Serial.print(x)
-#define DEBUG_PRINTLN(x) Serial.println(x)
-#else
-#define DEBUG_PRINT(x)
-#define DEBUG_PRINTLN(x)
+// Longest unsolicited result line kept between AT commands (+CTZE is about 40)
+#ifndef QUECTEL_URC_LINE_MAX
+#define QUECTEL_URC_LINE_MAX 64
 #endif
 
+class GNSSKalmanFilter;
+class GNSSReportFilter;
+class GeofenceEngine;
+class TrackSimplifier;
+
 // AT Command Response Codes
 enum ATResponseCode {
     AT_OK = 0,
@@ -133,14 +147,112 @@ enum TimeQueryMode {
     TIME_MODE_LOCAL = 2        // Current local time
 };
 
+// GNSS Engine State
+enum GNSSEngineState {
+    GNSS_STATE_OFF = 0,
+    GNSS_STATE_ACQUIRING = 1,  // Powered, no fix yet
+    GNSS_STATE_FIXED = 2,      // Powered, tracking a fix
+    GNSS_STATE_COUNT = 3
+};
+
+// GNSS Duty-Cycle Strategy
+enum GNSSDutyStrategy {
+    GNSS_DUTY_AUTO = 0,        // Pick from fix interval and learned acquisition time
+    GNSS_DUTY_CONTINUOUS = 1,  // Keep GNSS on, poll at the fix interval
+    GNSS_DUTY_PERIODIC = 2,    // Power on, acquire (hot start), power off
+    GNSS_DUTY_MOTION = 3       // Periodic, but only after gnssNotifyMotion() or a heartbeat
+};
+
+// GNSS Start Mode (AT+QGPSDEL delete type)
+enum GNSSStartMode {
+    GNSS_START_COLD = 0,       // Delete all assistance data
+    GNSS_START_HOT = 1,        // Keep everything
+    GNSS_START_WARM = 2        // Delete ephemeris, keep almanac/time/position
+};
+
+// Runs kept by runTTFFBenchmark()
+#ifndef GNSS_TTFF_MAX_RUNS
+#define GNSS_TTFF_MAX_RUNS 32
+#endif
+
+// TTFF Benchmark Results
+struct GNSSTTFFStats {
+    GNSSStartMode mode;
+    uint8_t runs;              // Runs attempted
+    uint8_t fixes;             // Runs that reached a fix within the timeout
+    unsigned long minMs;
+    unsigned long medianMs;
+    unsigned long p90Ms;
+    unsigned long maxMs;
+    unsigned long meanMs;
+    unsigned long samples[GNSS_TTFF_MAX_RUNS]; // TTFF of each successful run, sorted
+};
+
+// GNSS Power Statistics
+struct GNSSPowerStats {
+    unsigned long timeInState[GNSS_STATE_COUNT]; // ms, indexed by GNSSEngineState
+    float energyMah;           // Estimated from the power model
+    uint32_t powerOnCount;
+    uint32_t fixCount;         // Fixes delivered by gnssDutyCycleService()
+    uint32_t failedAcquisitions;
+    unsigned long acquireEstimateMs; // Learned power-on to first fix time
+    unsigned long lastTtffMs;  // Time to first fix of the latest power-on (0 = none yet)
+};
+
+// GNSS Constellation Combination (AT+QGPSCFG="gnssconfig")
+// Values follow the EC200U GNSS application note; firmware builds differ in
+// which combinations they accept, see the AT+QGPSCFG=? test response.
+enum GNSSConstellationConfig {
+    GNSS_CONFIG_GPS_BEIDOU = 1,
+    GNSS_CONFIG_GPS_GLONASS = 2,
+    GNSS_CONFIG_GPS_GALILEO = 3,
+    GNSS_CONFIG_GPS_ONLY = 4,
+    GNSS_CONFIG_GPS_GLONASS_GALILEO = 5,
+    GNSS_CONFIG_GPS_BEIDOU_GALILEO = 6
+};
+
+// NMEA Sentence Types (bitmask for the *nmeatype settings)
+enum GNSSNMEAType {
+    GNSS_NMEA_NONE = 0x00,
+    GNSS_NMEA_GGA = 0x01,
+    GNSS_NMEA_RMC = 0x02,
+    GNSS_NMEA_GSV = 0x04,
+    GNSS_NMEA_GSA = 0x08,
+    GNSS_NMEA_VTG = 0x10,
+    GNSS_NMEA_ALL = 0x1F
+};
+
+// NMEA Output Port (AT+QGPSCFG="outport")
+enum GNSSNMEAPort {
+    GNSS_NMEA_PORT_NONE = 0,
+    GNSS_NMEA_PORT_USB = 1,    // "usbnmea"
+    GNSS_NMEA_PORT_UART = 2    // "uartnmea"
+};
+
+// Applied GNSS Configuration (-1 = not applied or read yet)
+struct GNSSConfig {
+    int constellations;    // GNSSConstellationConfig
+    int nmeaSource;        // 1 = NMEA readable via AT+QGPSGNMEA
+    int outputPort;        // GNSSNMEAPort
+    int fixRateHz;         // Fix/NMEA output rate
+    int nmeaTypes[GNSS_CONSTELLATION_COUNT]; // GNSSNMEAType mask, indexed by GNSSConstellation
+};
+
+// Position Source
+enum PositionSource {
+    POSITION_SOURCE_NONE = 0,
+    POSITION_SOURCE_GNSS = 1,  // AT+QGPSLOC fix
+    POSITION_SOURCE_CELL = 2   // Cell-based coarse location (AT+QCELLLOC)
+};
+
 // GNSS Position Data Structure
 struct GNSSPosition {
     bool valid;
     String utcTime;        // hhmmss.sss
     double latitude;       // Decimal degrees
     double longitude;      // Decimal degrees
-    String latitudeStr;    // Original format string
-    String longitudeStr;   // Original format string
+    String latitudeStr;    // Original format string, empty after filtering
+    String longitudeStr;   // Original format string, empty after filtering
     float hdop;           // Horizontal dilution of precision
     float altitude;       // Meters above sea level
     uint8_t fixMode;      // 2=2D, 3=3D
@@ -148,14 +260,44 @@ struct GNSSPosition {
     float speedKmh;       // Speed in km/h
     float speedKnots;     // Speed in knots
     String date;          // ddmmyy
+    uint64_t epochMs;     // Unix time in ms (UTC) from utcTime/date, 0 if unknown
+    int64_t epochTicksUs; // quectelTicksUs() when epochMs was current, 0 if unknown
+    uint32_t timeUncertaintyUs; // Error bound of epochTicksUs
     uint8_t numSatellites; // Number of satellites
+    PositionSource source; // Where the position came from
+    float accuracyMeters; // Estimated horizontal accuracy
     int lastError;        // Last error code if failed
 };
 
+// GNSS Satellite Summary (from GSV/GSA sentences)
+struct GNSSSatelliteSummary {
+    bool valid;
+    uint8_t satellitesInView;  // Sum over all constellations (GSV)
+    uint8_t satellitesUsed;    // Satellites used in the solution (GSA)
+    float pdop;                // Position dilution of precision
+    float hdop;                // Horizontal dilution of precision
+};
+
+// Serving Cell Information (AT+QENG="servingcell")
+struct CellInfo {
+    bool valid;
+    String rat;           // "LTE" or "GSM"
+    int mcc;
+    int mnc;
+    uint32_t areaCode;    // TAC (LTE) or LAC (GSM)
+    uint32_t cellId;
+    int channel;          // EARFCN (LTE) or ARFCN (GSM)
+    int signalDbm;        // RSRP (LTE) or RSSI (GSM)
+    int lastError;        // Last error code if failed
+};
+
+// Longest +QLTS/+CCLK time string kept in NetworkTime::dateTime
+#define NETWORK_TIME_STR_LEN 32
+
 // Network Time Data Structure
 struct NetworkTime {
     bool valid;
-    String dateTime;      // YYYY/MM/dd,hh:mm:ss±zz
+    char dateTime[NETWORK_TIME_STR_LEN]; // Time string as reported (+QLTS or +CCLK)
     int year;
     int month;
     int day;
@@ -165,9 +307,78 @@ struct NetworkTime {
     int timezone;         // In quarters of hour from GMT
     int timezoneHours;    // Calculated hours from GMT
     bool daylightSaving;  // DST adjustment
+    uint64_t epochMs;     // Unix time in ms (UTC)
     int lastError;        // Last error code if failed
 };
 
+// Outcome of the last AT transaction
+struct QuectelStatus {
+    int code;             // ATResponseCode (AT_CME_ERROR - n for CME errors)
+    int cmeError;         // CME error code, -1 if none
+    int sslError;         // SSL/TCP stack error (+QSSLOPEN, +QNTP), 0 if none
+    unsigned long elapsedMs; // Command sent to final result
+    char command[QUECTEL_STATUS_CMD_LEN]; // Command as sent, truncated
+};
+
+// Modem Recovery Steps (escalation order)
+enum ModemRecoveryStep {
+    RECOVERY_NONE = 0,
+    RECOVERY_AT_PROBE = 1,     // Leave data mode and retry AT
+    RECOVERY_CFUN_RESET = 2,   // AT+CFUN=1,1
+    RECOVERY_RESET_PIN = 3,    // Pulse RESET_N
+    RECOVERY_POWER_CYCLE = 4,  // PWRKEY off, then on
+    RECOVERY_STEP_COUNT = 5
+};
+
+// Modem Health State
+enum ModemHealthState {
+    MODEM_HEALTHY = 0,
+    MODEM_DEGRADED = 1,        // Failures below the recovery threshold
+    MODEM_UNRESPONSIVE = 2,    // Threshold reached, recovery due
+    MODEM_DOWN = 3             // Every step failed; commands fail fast until the next attempt
+};
+
+// Modem Health Statistics
+struct ModemHealthStats {
+    ModemHealthState state;
+    uint32_t timeouts;         // Commands that got no final result code
+    uint32_t garbageResponses; // Commands that got data but no final result code
+    uint8_t consecutiveFailures;
+    uint32_t outages;          // Times the recovery threshold was reached
+    uint32_t recoveries[RECOVERY_STEP_COUNT]; // Recovered outages, by the step that worked
+    uint32_t failedRecoveries; // Escalations where every step failed
+    unsigned long downtimeMs;  // Total time from first failure to recovery
+    unsigned long lastDowntimeMs;
+    unsigned long longestDowntimeMs;
+    unsigned long backoffMs;   // Wait before the next escalation while down
+};
+
+// Called after each recovery step that was attempted
+typedef void (*RecoveryCallback)(ModemRecoveryStep step, bool success, void* context);
+
+// NTP Synchronization Result
+struct NTPResult {
+    bool valid;
+    int samples;          // +QNTP responses combined into the estimate
+    uint64_t epochMs;     // UTC at the last response, in ms
+    int32_t offsetMs;     // NTP time minus the local clock (0 if it was not synced)
+    uint32_t rttMs;       // Shortest command to +QNTP round trip
+    uint32_t uncertaintyMs; // Half-width of the time estimate
+    int lastError;        // +QNTP error code (e.g. 565 DNS failure) or CME error
+};
+
+// Called when the network reports a time zone or daylight saving change
+typedef void (*TimeZoneCallback)(int timezone, bool daylightSaving, void* context);
+
+// Best Available Time
+struct TimeEstimate {
+    bool valid;
+    uint64_t epochMs;     // UTC in ms
+    ClockSource source;   // Source of the last accepted sync
+    uint32_t uncertaintyMs; // Sync uncertainty plus holdover drift since
+    unsigned long ageMs;  // Time since the last accepted sync
+};
+
 // SSL Connection State
 struct SSLConnectionState {
     bool connected;
@@ -196,9 +407,99 @@ private:
     bool transparentMode;
     int currentSSLClient;
 
+    // Adaptive GNSS acquisition poll bounds
+    unsigned long acqMinPollMs;
+    unsigned long acqMaxPollMs;
+
+    // Last-fix cache used by isGNSSFixed()
+    bool fixSeen;
+    unsigned long lastFixTime;
+    unsigned long fixCacheWindowMs;
+
+    // Optional stages applied to every fix (filter, geofences, simplifier)
+    GNSSKalmanFilter* positionFilter;
+    GNSSReportFilter* reportFilter;
+    GeofenceEngine* geofenceEngine;
+    TrackSimplifier* trackSimplifier;
+
+    // GNSS engine state and duty-cycle scheduler
+    GNSSEngineState gnssState;
+    unsigned long gnssStateSince;
+    unsigned long gnssPowerOnTime;
+    bool gnssFirstFixPending;
+    GNSSPowerStats gnssPowerStats;
+    float gnssCurrentMa[GNSS_STATE_COUNT];
+    unsigned long dutyIntervalMs;
+    float dutyTargetHdop;
+    unsigned long dutyAcquireTimeoutMs;
+    unsigned long dutyHeartbeatMs;
+    GNSSDutyStrategy dutyStrategy;
+    bool dutyFixTaken;
+    unsigned long dutyLastFixTime;
+    bool motionAware;
+    bool motionPending;
+
+    // GNSS settings as last applied or read, used to skip redundant AT+QGPSCFG writes
+    GNSSConfig gnssConfig;
+
+    // Cell-based location fallback
+    float cellAccuracyMeters;
+
+    // Satellite tables fed from GSV/GSA sentences
+    NMEAParser nmeaParser;
+
+    // Optional dedicated NMEA port, read outside AT transactions
+    Stream* nmeaStream;
+    char nmeaLine[QUECTEL_NMEA_LINE_MAX];
+    uint8_t nmeaLineLength;
+    GNSSPosition nmeaPosition;
+    unsigned long nmeaPositionTime;
+    uint32_t nmeaByteUs;       // Transfer time of one byte at the NMEA port's baud rate
+    int64_t nmeaLastByteUs;    // Latest arrival of the last byte read
+    int64_t nmeaPollUs;        // End of the last serviceNMEA() pass
+    int64_t nmeaBurstUs;       // Estimated arrival of the first byte of the current burst
+    uint32_t nmeaBurstUncertaintyUs; // Half the window nmeaBurstUs lies in
+    uint16_t nmeaLatencyMs;    // Fix epoch to first NMEA byte, module-specific
+
+    // Local UTC clock seeded from network, RTC and GNSS time
+    QuectelClock softClock;
+    String ntpServer;          // Server of the last successful syncTimeNTP()
+    bool daylightSaving;       // Last DST flag from +QLTS/+CTZE
+
+    // Unsolicited result lines read between AT commands
+    char urcLine[QUECTEL_URC_LINE_MAX];
+    uint8_t urcLineLength;
+    bool timeZoneReports;      // AT+CTZR enabled
+    TimeZoneCallback timeZoneCallback;
+    void* timeZoneContext;
+    int64_t responseTicksUs;   // quectelTicksUs() when the last AT response completed
+
     // Internal buffer for AT responses
     String responseBuffer;
 
+    // Last AT transaction
+    QuectelStatus lastStatus;
+    unsigned long statusStartTime;
+    size_t statusBytesOut;
+#if QUECTEL_METRICS
+    QuectelMetrics metrics;
+#endif
+#if QUECTEL_TRACE
+    QuectelTrace trace;
+#endif
+
+    // Health watchdog
+    ModemHealthStats health;
+    uint8_t recoveryThreshold;
+    int pwrkeyPin;
+    int resetPin;
+    uint8_t pinAssertLevel;
+    unsigned long outageStart;     // millis() of the first failure of the current run
+    unsigned long nextRecoveryTime;
+    bool recovering;
+    RecoveryCallback recoveryCallback;
+    void* recoveryContext;
+
     // Helper functions
     bool sendATCommand(const String& command, unsigned long customTimeout = 0);
     String readResponse(unsigned long customTimeout = 0);
@@ -206,16 +507,51 @@ private:
     int parseATResponse(const String& response);
     int parseCMEError(const String& response);
     int parseSSLError(const String& response);
+    void beginStatus(const String& command);
+    int endStatus(int code, int sslError = 0, size_t responseLength = 0);
+    bool failFast(const String& command);
+    void traceCommand(const String& command);
+    void traceResponse(const String& response);
+    void noteHealth(int code, bool garbage);
+    void endOutage();
+    bool runRecoveryStep(ModemRecoveryStep step);
+    bool waitForBoot();
+    void pulsePin(int pin, unsigned long ms);
 
     // Parse helper functions
     bool parseGNSSResponse(const String& response, GNSSPosition& position, GNSSCoordFormat format);
-    bool parseNetworkTime(const String& response, NetworkTime& time);
+    bool parseNetworkTime(const String& response, NetworkTime& time, bool localTime);
+    int queryNTP(const String& command, unsigned long timeoutMs, NetworkTime& time,
+                 int64_t& sentUs, int64_t& receivedUs);
     double convertCoordinateToDecimal(const String& coord, bool isLongitude, GNSSCoordFormat format);
+    void feedNMEA(const String& response);
+    void summarizeSkyView(GNSSSatelliteSummary& summary);
+    void handleNMEALine();
+    void handleURC(const char* line, size_t length);
+    void updateTimeZone(int timezone, bool dst);
+    void handleResponseURCs(const String& response);
+    void serviceDelay(unsigned long ms);
+    void processFix(GNSSPosition& position);
+    void setGNSSState(GNSSEngineState state);
+    bool applyGNSSConfig(const char* name, int value, int& cached, const char* valueText = nullptr);
+    bool queryGNSSConfig(const char* name, String& value);
+    void noteGNSSError(int cmeError);
+    void noteGNSSFix(unsigned long fixTime);
+    unsigned long nextAcquisitionPoll(const GNSSSatelliteSummary& summary, float lastHdop, float hdop,
+                                      unsigned long lastInterval);
 
 public:
     // Constructor
     QuectelEC200U(HardwareSerial* serial, uint32_t baud = 115200);
 
+    /**
+     * Constructor with a dedicated NMEA port
+     * @param serial AT command port
+     * @param nmeaSerial Port wired to the modem's NMEA output (initialised by the caller)
+     * @param baud AT port baud rate
+     */
+    QuectelEC200U(HardwareSerial* serial, Stream* nmeaSerial, uint32_t baud = 115200);
+
     // Basic modem control
     bool begin();
     bool testAT();
@@ -228,6 +564,66 @@ public:
     void setTimeout(unsigned long ms) { timeout = ms; }
     unsigned long getTimeout() { return timeout; }
 
+    // ========== Health Watchdog ==========
+
+    /**
+     * Set the GPIOs used for hardware recovery
+     * The off pulse on PWRKEY is long enough to power the modem down, the on
+     * pulse only long enough to power it up, so a power cycle cannot leave
+     * the modem off whatever state it was in.
+     * @param pwrkeyGpio GPIO driving PWRKEY (-1 = none)
+     * @param resetGpio GPIO driving RESET_N (-1 = none)
+     * @param assertLevel Pin level that pulls the modem line low (HIGH for the
+     *                    usual NPN driver stage)
+     */
+    void setRecoveryPins(int pwrkeyGpio, int resetGpio = -1, uint8_t assertLevel = HIGH);
+
+    /**
+     * Set how many consecutive failed commands count as an outage
+     * @param failures Timeouts or garbage responses in a row (default 3)
+     */
+    void setRecoveryThreshold(uint8_t failures) { recoveryThreshold = failures > 0 ? failures : 1; }
+
+    /**
+     * Run recovery when due; call from loop()
+     *
+     * Any final result code, including ERROR, proves the modem is alive;
+     * commands that time out or return garbage count as failures. Once
+     * the threshold is reached the escalation runs: AT probe, AT+CFUN=1,1,
+     * RESET_N pulse, PWRKEY power cycle (pin steps only when configured).
+     * If every step fails the modem is marked down and commands fail at
+     * once instead of waiting out their timeout; escalation is retried
+     * with exponential backoff (30 s to 15 min).
+     *
+     * @return Health state after the call
+     */
+    ModemHealthState healthService();
+
+    /**
+     * Run the recovery escalation now (blocking, up to a few minutes)
+     * After a CFUN reset or power cycle, echo and verbose errors are set
+     * again, the GNSS configuration cache is cleared and time zone reports
+     * are re-enabled.
+     * @return true if a step brought the modem back
+     */
+    bool recoverModem();
+
+    /**
+     * Set a callback for each attempted recovery step
+     */
+    void setRecoveryCallback(RecoveryCallback cb, void* context = nullptr) {
+        recoveryCallback = cb;
+        recoveryContext = context;
+    }
+
+    ModemHealthState getHealthState() const { return health.state; }
+    const ModemHealthStats& getHealthStats() const { return health; }
+
+    /**
+     * Clear the counters (the current state is kept)
+     */
+    void resetHealthStats();
+
     // ========== GNSS/GPS Functions ==========
 
     /**
@@ -250,8 +646,160 @@ public:
      */
     bool gnssOff();
 
+    // ========== GNSS Configuration ==========
+
+    /**
+     * Select the constellations used for positioning
+     * GNSS must be off; the modem rejects the change while a session is running.
+     * @param config Constellation combination
+     * @return true if applied (or already active), false otherwise
+     */
+    bool setGNSSConstellations(GNSSConstellationConfig config);
+
+    /**
+     * Select the NMEA sentences output for one constellation
+     * GPS uses the GNSS_NMEA_* bits directly; for GLONASS, BeiDou and Galileo
+     * the modem defines which bits it honours (typically GSV and GSA).
+     * @param constellation Constellation whose *nmeatype setting is written
+     * @param typeMask OR of GNSSNMEAType values (GNSS_NMEA_NONE disables output)
+     * @return true if applied (or already active), false otherwise
+     */
+    bool setNMEATypes(GNSSConstellation constellation, uint8_t typeMask);
+
+    /**
+     * Select the port that carries unsolicited NMEA output
+     * @param port Output port (GNSS_NMEA_PORT_NONE to stop the stream)
+     * @return true if applied (or already active), false otherwise
+     */
+    bool setNMEAOutputPort(GNSSNMEAPort port);
+
+    /**
+     * Set the fix and NMEA output rate
+     * @param hz Fixes per second (1, 2, 5 or 10 depending on firmware)
+     * @return true if applied (or already active), false otherwise
+     */
+    bool setNMEAOutputRate(uint8_t hz);
+
+    /**
+     * Enable or disable reading NMEA sentences with AT+QGPSGNMEA
+     * @param enable true to enable (gnssBegin() default)
+     * @return true if applied (or already active), false otherwise
+     */
+    bool setNMEASource(bool enable);
+
+    /**
+     * Read the current settings from the modem into the cache
+     * Settings the firmware does not report are left at -1.
+     * @return true if every setting was read, false otherwise
+     */
+    bool readGNSSConfig();
+
+    /**
+     * Forget the cached settings; the next setter always writes to the modem
+     */
+    void invalidateGNSSConfig();
+
+    /**
+     * Get the settings as last applied or read
+     * @return Cached configuration (-1 = unknown)
+     */
+    const GNSSConfig& getGNSSConfig() { return gnssConfig; }
+
+    // ========== GNSS Power Management ==========
+
+    /**
+     * Configure the duty-cycle scheduler driven by gnssDutyCycleService()
+     * @param fixIntervalMs Target time between fixes (0 = scheduler disabled)
+     * @param targetHdop Accuracy target for each fix (default 2.0)
+     * @param strategy Strategy, or GNSS_DUTY_AUTO to choose from the power model
+     * @param acquireTimeoutMs Budget for one acquisition (default 60000)
+     */
+    void gnssSetDutyCycle(unsigned long fixIntervalMs, float targetHdop = 2.0,
+                          GNSSDutyStrategy strategy = GNSS_DUTY_AUTO,
+                          unsigned long acquireTimeoutMs = 60000);
+
+    /**
+     * Run the duty-cycle scheduler; call from loop()
+     *
+     * Powers GNSS on and off according to the active strategy and acquires a
+     * fix when one is due. Blocks for at most the acquisition budget.
+     *
+     * @param position Reference to GNSSPosition structure to store a new fix
+     * @return true if a new fix was stored in position
+     */
+    bool gnssDutyCycleService(GNSSPosition& position);
+
+    /**
+     * Report motion (e.g. from an accelerometer) to the motion-triggered strategy
+     */
+    void gnssNotifyMotion() {
+        motionAware = true;
+        motionPending = true;
+    }
+
+    /**
+     * Set the heartbeat fix interval used by GNSS_DUTY_MOTION while stationary
+     * @param ms Interval in ms (default 900000)
+     */
+    void gnssSetMotionHeartbeat(unsigned long ms) { dutyHeartbeatMs = ms; }
+
+    /**
+     * Set the supply current model used for energy accounting and GNSS_DUTY_AUTO
+     * @param acquiringMa Current while acquiring (default 40)
+     * @param trackingMa Current while tracking a fix (default 30)
+     * @param offMa Current while off (default 0)
+     */
+    void gnssSetPowerModel(float acquiringMa, float trackingMa, float offMa = 0);
+
+    /**
+     * Get the strategy the scheduler currently uses (resolves GNSS_DUTY_AUTO)
+     */
+    GNSSDutyStrategy gnssGetActiveStrategy();
+
+    GNSSEngineState getGNSSState() { return gnssState; }
+
+    /**
+     * Clear assistance data so the next gnssOn() performs a cold, warm or hot start
+     * GNSS is turned off first if it is running.
+     * @param mode Start mode to prepare
+     * @return true if successful, false otherwise
+     */
+    bool gnssSetStartMode(GNSSStartMode mode);
+
+    /**
+     * Get the time to first fix of the latest power-on, measured from
+     * gnssOn() to the first successful position query
+     * @return TTFF in ms, or 0 if no power-on has reached a fix yet
+     */
+    unsigned long getLastTTFF() { return gnssPowerStats.lastTtffMs; }
+
+    /**
+     * Measure the TTFF distribution of a start mode
+     *
+     * Each run turns GNSS off, prepares the start mode, powers on and polls
+     * until the first fix or the timeout. Leaves GNSS off. The learned
+     * acquisition estimate used by the duty-cycle scheduler is not changed.
+     *
+     * @param mode Start mode to measure
+     * @param runs Number of runs (at most GNSS_TTFF_MAX_RUNS)
+     * @param stats Reference to GNSSTTFFStats structure to store results
+     * @param timeoutMs Budget per run in ms (default 120000)
+     * @return true if at least one run reached a fix, false otherwise
+     */
+    bool runTTFFBenchmark(GNSSStartMode mode, uint8_t runs, GNSSTTFFStats& stats,
+                          unsigned long timeoutMs = 120000);
+
+    /**
+     * Get time-in-state, energy and acquisition counters (updated to now)
+     */
+    const GNSSPowerStats& getGNSSPowerStats();
+
     /**
      * Get current position (latitude and longitude)
+     *
+     * With an NMEA stream attached, a stream fix younger than the fix cache
+     * window is returned without an AT query (decimal degrees only).
+     *
      * @param position Reference to GNSSPosition structure to store results
      * @param format Coordinate format (default: decimal degrees)
      * @param maxRetries Maximum number of retries if not fixed (default: 10)
@@ -263,6 +811,174 @@ public:
                      int maxRetries = 10,
                      unsigned long retryDelay = 2000);
 
+    /**
+     * Acquire a position with an adaptive poll schedule
+     *
+     * Instead of polling AT+QGPSLOC at a constant rate, the next poll time is
+     * chosen from the satellites in view/used and the HDOP trend. Returns as
+     * soon as a fix with hdop <= targetHdop is obtained. If the budget expires
+     * first, the best fix seen so far is returned.
+     *
+     * @param position Reference to GNSSPosition structure to store results
+     * @param targetHdop HDOP that ends the acquisition early (default: 2.0)
+     * @param maxWaitMs Overall acquisition budget in ms (default: 60000)
+     * @param format Coordinate format (default: decimal degrees)
+     * @return true if any fix was obtained, false otherwise
+     */
+    bool acquirePosition(GNSSPosition& position,
+                         float targetHdop = 2.0,
+                         unsigned long maxWaitMs = 60000,
+                         GNSSCoordFormat format = GNSS_FORMAT_DECIMAL_DEGREES);
+
+    /**
+     * Get satellites in view/used and DOP values from the GNSS engine
+     * @param summary Reference to GNSSSatelliteSummary structure to store results
+     * @return true if successful, false otherwise
+     */
+    bool getSatelliteSummary(GNSSSatelliteSummary& summary);
+
+    /**
+     * Refresh the per-constellation satellite tables from GSV/GSA sentences
+     * @return true if successful, false otherwise
+     */
+    bool updateSkyView();
+
+    /**
+     * Get the satellite tables (GPS, GLONASS, BeiDou, Galileo) and DOP values
+     * from the last updateSkyView()
+     */
+    const GNSSSkyView& getSkyView() const { return nmeaParser.getSkyView(); }
+
+    /**
+     * Attach a port carrying the modem's NMEA output
+     *
+     * Sentences are read without blocking by serviceNMEA(), which the library
+     * also calls while it waits for AT responses, so the stream keeps flowing
+     * during slow commands such as httpsConnect(). Every RMC fix runs through
+     * the attached filter, report, geofence and simplifier stages, so their
+     * callbacks may run inside other library calls and must not send AT commands.
+     *
+     * @param stream NMEA port, or nullptr to detach
+     * @param baud NMEA port baud rate, used to back-date sentence arrival times
+     */
+    void setNMEAStream(Stream* stream, uint32_t baud = 115200) {
+        nmeaStream = stream;
+        nmeaLineLength = 0;
+        nmeaByteUs = 10000000UL / baud;
+    }
+
+    /**
+     * Read and parse all pending NMEA stream data; call from loop()
+     */
+    void serviceNMEA();
+
+    /**
+     * Get the latest fix from the NMEA stream
+     * Only decimal fields are filled in; the String fields are left empty.
+     * @param position Reference to GNSSPosition structure to store results
+     * @param maxAgeMs Oldest fix accepted in ms (default 2000)
+     * @return true if a fix no older than maxAgeMs is available
+     */
+    bool getNMEAPosition(GNSSPosition& position, unsigned long maxAgeMs = 2000);
+
+    /**
+     * Set the delay between a fix epoch and the first byte of its NMEA burst
+     *
+     * Stream fixes are timed from the first byte after an idle gap; this
+     * module-specific latency (measure it against a PPS output) is subtracted
+     * when GNSS time is fed to the local clock.
+     *
+     * @param ms Latency in ms (default 0)
+     */
+    void setNMEALatency(uint16_t ms) { nmeaLatencyMs = ms; }
+
+    /**
+     * Get the NMEA parser holding the satellite tables
+     */
+    NMEAParser& getNMEAParser() { return nmeaParser; }
+
+    /**
+     * Set the poll interval bounds used by acquirePosition()
+     * @param minMs Shortest interval, used when a fix is imminent (default 500)
+     * @param maxMs Longest interval, used when no satellites are visible (default 8000)
+     */
+    void setAcquisitionPollBounds(unsigned long minMs, unsigned long maxMs) {
+        acqMinPollMs = minMs;
+        acqMaxPollMs = (maxMs > minMs) ? maxMs : minMs;
+    }
+
+    /**
+     * Attach a filter stage applied to every fix returned by the library
+     * @param filter Filter instance (see GNSSFilter.h), or nullptr to disable
+     */
+    void setPositionFilter(GNSSKalmanFilter* filter) { positionFilter = filter; }
+
+    /**
+     * Attach a report filter that classifies every fix as moving, stop,
+     * heartbeat, motion start or suppressed (applied after the position filter)
+     *
+     * While it reports the device as stationary, the periodic and
+     * motion-triggered duty-cycle strategies only take heartbeat fixes
+     * until gnssNotifyMotion() is called.
+     *
+     * @param filter Filter instance (see GNSSFilter.h), or nullptr to disable
+     */
+    void setReportFilter(GNSSReportFilter* filter) { reportFilter = filter; }
+
+    /**
+     * Attach a geofence engine that is updated with every fix returned by the library
+     * @param engine Engine instance (see Geofence.h), or nullptr to disable
+     */
+    void setGeofenceEngine(GeofenceEngine* engine) { geofenceEngine = engine; }
+
+    /**
+     * Attach a track simplifier fed with every fix returned by the library
+     *
+     * Its callback receives only significant vertices; use it to fill the
+     * upload batch instead of queueing every fix.
+     *
+     * @param simplifier Simplifier instance (see TrackSimplifier.h), or nullptr to disable
+     */
+    void setTrackSimplifier(TrackSimplifier* simplifier) { trackSimplifier = simplifier; }
+
+    /**
+     * Get the fastest available position: GNSS if a fix arrives within the
+     * budget, otherwise a coarse cell-based location
+     *
+     * Cell positions are not passed to the attached filter, geofence or
+     * simplifier stages; check position.source and position.accuracyMeters.
+     *
+     * @param position Reference to GNSSPosition structure to store results
+     * @param gnssBudgetMs Time allowed for a GNSS fix before falling back (default 3000)
+     * @param cellTimeoutMs Timeout for the cell location request (default 10000)
+     * @return true if a position was obtained from either source, false otherwise
+     */
+    bool getBestPosition(GNSSPosition& position, unsigned long gnssBudgetMs = 3000,
+                         unsigned long cellTimeoutMs = 10000);
+
+    /**
+     * Get a coarse position from the serving and neighbour cells (AT+QCELLLOC)
+     * Requires network registration and an active data context.
+     * @param position Reference to GNSSPosition structure to store results
+     * @param timeoutMs Request timeout in ms (default 10000)
+     * @return true if successful, false otherwise
+     */
+    bool getCellLocation(GNSSPosition& position, unsigned long timeoutMs = 10000);
+
+    /**
+     * Get the serving cell identity and signal (AT+QENG="servingcell")
+     * Use this to resolve the location with an external cell database.
+     * @param cell Reference to CellInfo structure to store results
+     * @return true if successful, false otherwise
+     */
+    bool getServingCell(CellInfo& cell);
+
+    /**
+     * Set the accuracy reported for cell-based positions
+     * @param meters Estimated horizontal accuracy (default 1000)
+     */
+    void setCellLocationAccuracy(float meters) { cellAccuracyMeters = meters; }
+
     /**
      * Get only latitude and longitude as doubles
      * @param latitude Reference to store latitude
@@ -273,10 +989,27 @@ public:
 
     /**
      * Check if GNSS has a valid fix
+     *
+     * Answers from the last-fix cache without a modem round trip when a fix was
+     * seen within the cache window. Otherwise sends a single AT+QGPSLOC query
+     * without parsing the position or starting the GNSS session.
+     *
      * @return true if fixed, false otherwise
      */
     bool isGNSSFixed();
 
+    /**
+     * Set how long a previously seen fix answers isGNSSFixed()
+     * @param ms Cache window in ms (0 = always query the modem, default 2000)
+     */
+    void setFixCacheWindow(unsigned long ms) { fixCacheWindowMs = ms; }
+
+    /**
+     * Get time since the last successful fix
+     * @return Age in ms, or ULONG_MAX if no fix has been seen since gnssOff()
+     */
+    unsigned long getFixAge();
+
     // ========== SSL/HTTPS Functions ==========
 
     /**
@@ -426,14 +1159,168 @@ public:
      */
     bool syncTimeFromNetwork();
 
+    /**
+     * Sync time from an NTP server (AT+QNTP)
+     *
+     * +QNTP reports whole seconds, so each response only bounds the time to
+     * a one-second window between the command and the URC. The windows of
+     * several queries are intersected to estimate the sub-second offset; the
+     * result is fed to the local clock and the modem RTC is set as well.
+     * The PDP context must be active.
+     *
+     * @param server NTP server name or address
+     * @param result Reference to store offset, round trip and uncertainty
+     * @param samples Queries to combine (1-8)
+     * @param contextID PDP context ID (1-7)
+     * @param port NTP server port
+     * @param timeoutMs Time to wait for each +QNTP response
+     * @return true if successful, false otherwise
+     */
+    bool syncTimeNTP(const String& server, NTPResult& result, int samples = 4,
+                     int contextID = 1, int port = 123, unsigned long timeoutMs = 30000);
+
+    /**
+     * Enable or disable time zone change reports (AT+CTZR)
+     *
+     * With reports on, the network's +CTZE (zone, DST and local time) or
+     * +CTZV (zone only) messages and unsolicited +QLTS lines update the local
+     * clock's time zone and NITZ time as they arrive. They are read by
+     * processURCs() and before every AT command, so no polling of
+     * getNetworkTime() is needed to follow DST or zone changes.
+     *
+     * @param enable true to subscribe, false to unsubscribe
+     * @return true if successful, false otherwise
+     */
+    bool setTimeZoneReporting(bool enable = true);
+
+    /**
+     * Dispatch unsolicited result lines waiting on the AT port; call from loop()
+     */
+    void processURCs();
+
+    /**
+     * Set a callback for network time zone and DST changes
+     * @param cb Called with the zone in quarters of an hour and the DST flag
+     * @param context Passed to the callback
+     */
+    void setTimeZoneCallback(TimeZoneCallback cb, void* context = nullptr) {
+        timeZoneCallback = cb;
+        timeZoneContext = context;
+    }
+
+    // ========== Local Clock ==========
+
+    /**
+     * Seed the local clock from network time (AT+QLTS), or the modem RTC
+     * (AT+CCLK) if the network has not sent NITZ
+     *
+     * The clock is also fed by every successful getNetworkTime(), getRTCTime()
+     * and GNSS fix, so explicit syncs are only needed when none of those run.
+     *
+     * @return true if the clock was updated, false otherwise
+     */
+    bool syncClock();
+
+    /**
+     * Resync the clock when its resync interval has elapsed; call from loop()
+     * @return true if the clock is synced
+     */
+    bool clockService();
+
+    /**
+     * Get UTC from the local clock without an AT round trip
+     * @return Milliseconds since 1970-01-01 UTC, or 0 if the clock was never synced
+     */
+    uint64_t getEpochMs() { return softClock.nowMs(); }
+
+    /**
+     * Get broken-down time from the local clock without an AT round trip
+     * @param time Reference to store time data (dateTime is set to "")
+     * @param local true for local time using the last known timezone, false for UTC
+     * @return true if the clock is synced, false otherwise
+     */
+    bool getClockTime(NetworkTime& time, bool local = true);
+
+    /**
+     * Set how often clockService() resyncs
+     * @param ms Interval in ms (default 3600000)
+     */
+    void setClockResyncInterval(unsigned long ms) { softClock.setResyncInterval(ms); }
+
+    /**
+     * Get the local clock (source, drift estimate, statistics)
+     */
+    QuectelClock& getClock() { return softClock; }
+
+    /**
+     * Get the best available time
+     *
+     * Answers from the local clock while its last sync is within maxAgeMs.
+     * Otherwise the clock is refreshed from the first source that answers,
+     * in order of accuracy: GNSS (NMEA stream, or AT+QGPSLOC while GNSS is
+     * running), NTP (server of the last successful syncTimeNTP()), NITZ
+     * (AT+QLTS) and the modem RTC (AT+CCLK). The NTP refresh is a single
+     * query with a 5 s wait.
+     *
+     * @param time Reference to store the time, its source and uncertainty
+     * @param maxAgeMs Oldest sync answered without refreshing
+     * @return true if the clock is synced and its last sync is within maxAgeMs
+     */
+    bool getBestTime(TimeEstimate& time, unsigned long maxAgeMs = 3600000);
+
     // ========== Error Handling ==========
 
     /**
-     * Get last error description
-     * @param errorCode Error code to describe
-     * @return String description of error
+     * Get error description
+     * @param errorCode AT result (AT_CME_ERROR - code for CME errors), SSL error
+     *                  or raw CME error code
+     * @return Description from a constant table (no allocation)
+     */
+    static const char* getErrorDescription(int errorCode);
+
+    /**
+     * Get the outcome of the last AT transaction
+     *
+     * Every command the library sends records its final result code, the
+     * CME or SSL error (from +QSSLOPEN/+QNTP, without an AT+QIGETERROR round
+     * trip), the time to the final result and the command itself. Read it
+     * after a call returns false to decide whether to retry.
+     *
+     * @return Status of the most recent command
+     */
+    const QuectelStatus& getLastStatus() const { return lastStatus; }
+
+#if QUECTEL_METRICS
+    /**
+     * Get per-command latency and error statistics
+     *
+     * Each transaction is counted under its command name with its final
+     * result, bytes in/out and latency (see QuectelMetrics.h). Use
+     * QuectelMetrics::percentile() for p50/p95/p99.
+     *
+     * @return Statistics table (fixed size, no heap)
      */
-    String getErrorDescription(int errorCode);
+    const QuectelMetrics& getMetrics() const { return metrics; }
+
+    /**
+     * Clear the per-command statistics
+     */
+    void resetMetrics() { metrics.reset(); }
+#endif
+
+#if QUECTEL_TRACE
+    /**
+     * Get the AT traffic trace
+     *
+     * Commands, responses and unsolicited lines are recorded in a binary
+     * ring buffer (see QuectelTrace.h) instead of being printed while the
+     * modem waits. Read it from loop() or another task with dump(),
+     * drain() or read().
+     *
+     * @return Trace buffer
+     */
+    QuectelTrace& getTrace() { return trace; }
+#endif
 
     /**
      * Get last SSL error details
@@ -0,0 +1,49 @@
+/**
+ * QuectelLog.cpp - Leveled logging for QuectelEC200U
+ *
+ * Author: ESP32 Arduino Library
+ * Date: 2024
+ */
+
+#include "QuectelLog.h"
+#include <stdarg.h>
+
+uint8_t quectelLogThreshold = QUECTEL_LOG_LEVEL;
+
+static QuectelLogSink logSink = nullptr;
+static void* logSinkContext = nullptr;
+
+void quectelSetLogLevel(uint8_t level) {
+    quectelLogThreshold = level;
+}
+
+void quectelSetLogSink(QuectelLogSink sink, void* context) {
+    logSink = sink;
+    logSinkContext = context;
+}
+
+const char* quectelLogLevelName(uint8_t level) {
+    static const char* const names[] = { "-", "E", "W", "I", "T" };
+    return level <= QUECTEL_LOG_TRACE ? names[level] : "?";
+}
+
+void quectelLogPrintf(uint8_t level, const char* format, ...) {
+    char message[QUECTEL_LOG_LINE_MAX];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+    if (length >= (int)sizeof(message)) {
+        // Mark the cut, as QuectelTrace does
+        memcpy(message + sizeof(message) - 4, "...", 4);
+    }
+
+    if (logSink != nullptr) {
+        logSink(level, message, logSinkContext);
+        return;
+    }
+    Serial.print("[");
+    Serial.print(quectelLogLevelName(level));
+    Serial.print("] ");
+    Serial.println(message);
+}
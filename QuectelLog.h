@@ -0,0 +1,94 @@
+/**
+ * QuectelLog.h - Leveled logging for QuectelEC200U
+ *
+ * Messages have a level (error, warn, info, trace). Levels above the
+ * compile-time floor QUECTEL_LOG_LEVEL are removed by the preprocessor and
+ * optimiser together with their arguments, so disabled trace messages cost
+ * neither code nor String formatting. The rest are checked against a
+ * runtime threshold before formatting and handed to a sink, Serial by
+ * default.
+ *
+ * Set the floor with a build flag, e.g. -DQUECTEL_LOG_LEVEL=QUECTEL_LOG_ERROR
+ * (PlatformIO build_flags, or compiler.cpp.extra_flags in the Arduino IDE).
+ * QUECTEL_DEBUG=0 without QUECTEL_LOG_LEVEL compiles all logging out.
+ *
+ * Author: ESP32 Arduino Library
+ * Date: 2024
+ */
+
+#ifndef QUECTEL_LOG_H
+#define QUECTEL_LOG_H
+
+#include <Arduino.h>
+
+#define QUECTEL_LOG_NONE 0
+#define QUECTEL_LOG_ERROR 1
+#define QUECTEL_LOG_WARN 2
+#define QUECTEL_LOG_INFO 3
+#define QUECTEL_LOG_TRACE 4
+
+#ifndef QUECTEL_DEBUG
+#define QUECTEL_DEBUG 1
+#endif
+
+// Compile-time floor: messages above it are not compiled in
+#ifndef QUECTEL_LOG_LEVEL
+#if QUECTEL_DEBUG
+#define QUECTEL_LOG_LEVEL QUECTEL_LOG_TRACE
+#else
+#define QUECTEL_LOG_LEVEL QUECTEL_LOG_NONE
+#endif
+#endif
+
+// Longest formatted message including the terminator; longer ones are cut
+// and end in "..."
+#ifndef QUECTEL_LOG_LINE_MAX
+#define QUECTEL_LOG_LINE_MAX 128
+#endif
+
+// Receives each formatted message (no line ending)
+typedef void (*QuectelLogSink)(uint8_t level, const char* message, void* context);
+
+// Runtime threshold, read inline by the logging macros
+extern uint8_t quectelLogThreshold;
+
+/**
+ * Set the runtime threshold
+ * @param level QUECTEL_LOG_NONE to QUECTEL_LOG_TRACE; levels above the
+ *              compile-time floor stay disabled
+ */
+void quectelSetLogLevel(uint8_t level);
+
+inline uint8_t quectelGetLogLevel() { return quectelLogThreshold; }
+
+/**
+ * Send messages to a custom sink instead of Serial
+ * @param sink Called with the level and message, nullptr to restore Serial
+ * @param context Passed to the sink
+ */
+void quectelSetLogSink(QuectelLogSink sink, void* context = nullptr);
+
+/**
+ * Format and emit a message; use the QLOG_* macros instead so that
+ * disabled levels are compiled out
+ */
+void quectelLogPrintf(uint8_t level, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+/**
+ * Short name of a level ("E", "W", "I", "T")
+ */
+const char* quectelLogLevelName(uint8_t level);
+
+#define QLOG(level, ...) \
+    do { \
+        if ((level) <= QUECTEL_LOG_LEVEL && (level) <= quectelLogThreshold) { \
+            quectelLogPrintf((level), __VA_ARGS__); \
+        } \
+    } while (0)
+
+#define QLOG_ERROR(...) QLOG(QUECTEL_LOG_ERROR, __VA_ARGS__)
+#define QLOG_WARN(...) QLOG(QUECTEL_LOG_WARN, __VA_ARGS__)
+#define QLOG_INFO(...) QLOG(QUECTEL_LOG_INFO, __VA_ARGS__)
+#define QLOG_TRACE(...) QLOG(QUECTEL_LOG_TRACE, __VA_ARGS__)
+
+#endif // QUECTEL_LOG_H
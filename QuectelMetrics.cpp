@@ -0,0 +1,139 @@
+/**
+ * QuectelMetrics.cpp - Per-command AT latency statistics for QuectelEC200U
+ *
+ * Author: ESP32 Arduino Library
+ * Date: 2024
+ */
+
+#include "QuectelMetrics.h"
+#include <limits.h>
+
+#if QUECTEL_METRICS
+
+// Roughly 1-2-5 steps; the last bucket takes everything longer
+static const uint32_t bucketLimits[QUECTEL_METRICS_BUCKETS] = {
+    5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 30000, 60000, UINT32_MAX
+};
+
+QuectelMetrics::QuectelMetrics() {
+    reset();
+}
+
+void QuectelMetrics::reset() {
+    memset(entries, 0, sizeof(entries));
+    entryCount = 0;
+}
+
+void QuectelMetrics::commandName(const char* command, char* name) {
+    const char* p = command;
+    if ((p[0] == 'A' || p[0] == 'a') && (p[1] == 'T' || p[1] == 't')) {
+        p += 2;
+    }
+    uint8_t length = 0;
+    while (*p != '\0' && *p != '=' && *p != '?' && *p != '\r' && *p != '\n' &&
+           length < QUECTEL_METRICS_NAME_LEN - 1) {
+        name[length++] = *p++;
+    }
+    if (length == 0) {
+        name[length++] = 'A';
+        name[length++] = 'T';
+    }
+    name[length] = '\0';
+}
+
+QuectelCommandStats* QuectelMetrics::entryFor(const char* name) {
+    for (uint8_t i = 0; i < entryCount; i++) {
+        if (strcmp(entries[i].name, name) == 0) {
+            return &entries[i];
+        }
+    }
+
+    // The last slot is kept for the shared overflow entry
+    const char* entryName = (entryCount < QUECTEL_METRICS_SLOTS - 1) ? name : "*";
+    if (entryName != name) {
+        for (uint8_t i = 0; i < entryCount; i++) {
+            if (strcmp(entries[i].name, entryName) == 0) {
+                return &entries[i];
+            }
+        }
+    }
+    QuectelCommandStats* entry = &entries[entryCount++];
+    strncpy(entry->name, entryName, QUECTEL_METRICS_NAME_LEN - 1);
+    entry->minMs = UINT32_MAX;
+    return entry;
+}
+
+void QuectelMetrics::record(const char* command, uint32_t elapsedMs, size_t bytesOut, size_t bytesIn,
+                            bool error, bool timeout) {
+    char name[QUECTEL_METRICS_NAME_LEN];
+    commandName(command, name);
+    QuectelCommandStats* entry = entryFor(name);
+
+    entry->count++;
+    if (error) {
+        entry->errors++;
+    }
+    if (timeout) {
+        entry->timeouts++;
+    }
+    entry->bytesOut += bytesOut;
+    entry->bytesIn += bytesIn;
+    entry->totalMs += elapsedMs;
+    if (elapsedMs < entry->minMs) {
+        entry->minMs = elapsedMs;
+    }
+    if (elapsedMs > entry->maxMs) {
+        entry->maxMs = elapsedMs;
+    }
+
+    uint8_t bucket = 0;
+    while (elapsedMs > bucketLimits[bucket]) {
+        bucket++;
+    }
+    entry->histogram[bucket]++;
+}
+
+const QuectelCommandStats* QuectelMetrics::find(const char* name) const {
+    for (uint8_t i = 0; i < entryCount; i++) {
+        if (strcmp(entries[i].name, name) == 0) {
+            return &entries[i];
+        }
+    }
+    return nullptr;
+}
+
+uint32_t QuectelMetrics::bucketLimitMs(uint8_t bucket) {
+    return bucket < QUECTEL_METRICS_BUCKETS ? bucketLimits[bucket] : UINT32_MAX;
+}
+
+uint32_t QuectelMetrics::percentile(const QuectelCommandStats& stats, uint8_t percent) {
+    if (stats.count == 0) {
+        return 0;
+    }
+
+    // Nearest rank, then linear within its bucket
+    uint32_t rank = ((uint64_t)stats.count * percent + 99) / 100;
+    if (rank == 0) {
+        rank = 1;
+    }
+    uint32_t below = 0;
+    for (uint8_t i = 0; i < QUECTEL_METRICS_BUCKETS; i++) {
+        uint32_t inBucket = stats.histogram[i];
+        if (below + inBucket >= rank) {
+            // The observed extremes narrow the first and last occupied buckets
+            uint32_t lower = (i == 0) ? 0 : bucketLimits[i - 1];
+            uint32_t upper = bucketLimits[i];
+            if (lower < stats.minMs) {
+                lower = stats.minMs;
+            }
+            if (upper > stats.maxMs) {
+                upper = stats.maxMs;
+            }
+            return lower + (uint32_t)((uint64_t)(upper - lower) * (rank - below) / inBucket);
+        }
+        below += inBucket;
+    }
+    return stats.maxMs;
+}
+
+#endif // QUECTEL_METRICS
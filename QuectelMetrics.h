@@ -0,0 +1,109 @@
+/**
+ * QuectelMetrics.h - Per-command AT latency statistics for QuectelEC200U
+ *
+ * Every AT transaction is recorded under its command name ("+QGPSLOC" for
+ * "AT+QGPSLOC=2", "AT" for a bare "AT"): count, errors, timeouts, bytes
+ * sent and received, and a fixed-bucket latency histogram from which
+ * p50/p95/p99 are estimated. The table is a fixed array, so recording and
+ * queries never touch the heap. Once QUECTEL_METRICS_SLOTS - 1 names are
+ * in use, further commands share a "*" entry.
+ *
+ * Build with QUECTEL_METRICS=0 to compile the instrumentation out.
+ *
+ * Author: ESP32 Arduino Library
+ * Date: 2024
+ */
+
+#ifndef QUECTEL_METRICS_H
+#define QUECTEL_METRICS_H
+
+#include <Arduino.h>
+
+#ifndef QUECTEL_METRICS
+#define QUECTEL_METRICS 1
+#endif
+
+// Command names tracked separately
+#ifndef QUECTEL_METRICS_SLOTS
+#define QUECTEL_METRICS_SLOTS 16
+#endif
+
+// Longest command name kept, including the terminator
+#define QUECTEL_METRICS_NAME_LEN 12
+
+// Latency histogram buckets (upper bounds 5 ms to 60 s, then overflow)
+#define QUECTEL_METRICS_BUCKETS 14
+
+// Statistics of one command name
+struct QuectelCommandStats {
+    char name[QUECTEL_METRICS_NAME_LEN];
+    uint32_t count;
+    uint32_t errors;           // ERROR, CME or SSL error
+    uint32_t timeouts;         // No final result code
+    uint32_t bytesOut;         // Command bytes including CR/LF
+    uint32_t bytesIn;          // Response bytes
+    uint32_t minMs;
+    uint32_t maxMs;
+    uint32_t totalMs;
+    uint32_t histogram[QUECTEL_METRICS_BUCKETS]; // Counts per latency bucket
+};
+
+class QuectelMetrics {
+private:
+    QuectelCommandStats entries[QUECTEL_METRICS_SLOTS];
+    uint8_t entryCount;
+
+    QuectelCommandStats* entryFor(const char* name);
+
+public:
+    QuectelMetrics();
+
+    /**
+     * Record one transaction
+     * @param command Command as sent (only the name is used)
+     * @param elapsedMs Command sent to final result
+     * @param bytesOut Bytes written
+     * @param bytesIn Bytes received
+     * @param error Final result was an error
+     * @param timeout No final result arrived
+     */
+    void record(const char* command, uint32_t elapsedMs, size_t bytesOut, size_t bytesIn,
+                bool error, bool timeout);
+
+    /**
+     * Find the statistics of a command name ("+CSQ", "AT", "*")
+     * @return Entry, or nullptr if the command was never recorded
+     */
+    const QuectelCommandStats* find(const char* name) const;
+
+    uint8_t getCount() const { return entryCount; }
+    const QuectelCommandStats& getEntry(uint8_t index) const { return entries[index]; }
+
+    /**
+     * Estimate a latency percentile from the histogram
+     * Interpolated within the bucket holding the rank and clamped to the
+     * observed minimum and maximum.
+     * @param stats Entry to inspect
+     * @param percent 1-100 (50, 95 and 99 for p50/p95/p99)
+     * @return ms, 0 if the entry is empty
+     */
+    static uint32_t percentile(const QuectelCommandStats& stats, uint8_t percent);
+
+    /**
+     * Upper bound of a histogram bucket in ms (UINT32_MAX for the last)
+     */
+    static uint32_t bucketLimitMs(uint8_t bucket);
+
+    /**
+     * Extract the command name used as the key ("AT+QGPSLOC=2" -> "+QGPSLOC")
+     * @param name Receives at most QUECTEL_METRICS_NAME_LEN - 1 characters
+     */
+    static void commandName(const char* command, char* name);
+
+    /**
+     * Forget all entries
+     */
+    void reset();
+};
+
+#endif // QUECTEL_METRICS_H
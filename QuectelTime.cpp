@@ -0,0 +1,211 @@
+/**
+ * QuectelTime.cpp - Allocation-free calendar arithmetic for QuectelEC200U
+ *
+ * Author: ESP32 Arduino Library
+ * Date: 2024
+ */
+
+#include "QuectelTime.h"
+#include <limits.h>
+
+#if defined(ESP32)
+#include <esp_timer.h>
+#endif
+
+// Drift estimates beyond this are treated as bad samples, not oscillator error
+#define CLOCK_MAX_DRIFT_PPM 500
+
+// Residual frequency error assumed between syncs, before and after drift estimation
+#define CLOCK_HOLDOVER_PPM 20
+#define CLOCK_HOLDOVER_TRACKED_PPM 2
+
+// Resolution of each source in µs, indexed by ClockSource; a drift baseline
+// must span 200000 resolutions to resolve 5 ppm. NTP is whole seconds
+// narrowed by combining several +QNTP responses.
+static const int64_t sourceResolutionUs[] = { 0, 1000000, 1000000, 250000, 1000 };
+
+// Two ASCII digits at p, or -1
+static int parseTwoDigits(const char* p) {
+    if (p[0] < '0' || p[0] > '9' || p[1] < '0' || p[1] > '9') {
+        return -1;
+    }
+    return (p[0] - '0') * 10 + (p[1] - '0');
+}
+
+uint64_t quectelParseNMEATime(const char* utcTime, const char* date) {
+    // Each field is checked before the next is read, so short fields stop at their terminator
+    int fields[6];
+    for (int i = 0; i < 6; i++) {
+        fields[i] = parseTwoDigits((i < 3 ? utcTime : date) + (i % 3) * 2);
+        if (fields[i] < 0) {
+            return 0;
+        }
+    }
+    int hour = fields[0];
+    int minute = fields[1];
+    int second = fields[2];
+    int day = fields[3];
+    int month = fields[4];
+    int year = fields[5];
+    if (hour > 23 || minute > 59 || second > 60 || day < 1 || day > 31 || month < 1 || month > 12) {
+        return 0;
+    }
+
+    // Fractional seconds: up to three digits, padded to milliseconds
+    uint32_t millisecond = 0;
+    if (utcTime[6] == '.') {
+        const char* p = utcTime + 7;
+        uint32_t scale = 100;
+        while (*p >= '0' && *p <= '9' && scale > 0) {
+            millisecond += (*p - '0') * scale;
+            scale /= 10;
+            p++;
+        }
+    }
+
+    year += (year < 80) ? 2000 : 1900;
+    return quectelEpochMs(year, month, day, hour, minute, second, millisecond);
+}
+
+void quectelCivilFromDays(int32_t days, int& year, int& month, int& day) {
+    // Inverse of quectelDaysFromCivil (March-based era arithmetic)
+    days += 719468;
+    int32_t era = (days >= 0 ? days : days - 146096) / 146097;
+    int32_t doe = days - era * 146097;
+    int32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int32_t mp = (5 * doy + 2) / 153;
+    day = doy - (153 * mp + 2) / 5 + 1;
+    month = mp < 10 ? mp + 3 : mp - 9;
+    year = yoe + era * 400 + (month <= 2 ? 1 : 0);
+}
+
+int64_t quectelTicksUs() {
+#if defined(ESP32)
+    return esp_timer_get_time();
+#else
+    static uint32_t lastMillis = 0;
+    static uint32_t wraps = 0;
+    uint32_t now = millis();
+    if (now < lastMillis) {
+        wraps++;
+    }
+    lastMillis = now;
+    return ((int64_t)wraps << 32 | now) * 1000;
+#endif
+}
+
+// ========== Software Clock ==========
+
+QuectelClock::QuectelClock() {
+    timezone = 0;
+    resyncIntervalMs = 3600000;
+    reset();
+}
+
+void QuectelClock::reset() {
+    synced = false;
+    source = CLOCK_SOURCE_NONE;
+    baseTicksUs = 0;
+    baseEpochUs = 0;
+    driftPpb = 0;
+    driftRefTicksUs = 0;
+    driftRefOffsetUs = 0;
+    driftRefResolutionUs = 0;
+    driftValid = false;
+    syncUncertaintyUs = 0;
+    memset(&stats, 0, sizeof(stats));
+}
+
+int64_t QuectelClock::predictUs(int64_t ticksUs) const {
+    int64_t elapsed = ticksUs - baseTicksUs;
+    return baseEpochUs + elapsed + elapsed * driftPpb / 1000000000LL;
+}
+
+bool QuectelClock::sync(uint64_t epochMs, int64_t ticksUs, ClockSource sampleSource,
+                        uint32_t uncertaintyUs) {
+    if (epochMs == 0 || sampleSource == CLOCK_SOURCE_NONE) {
+        return false;
+    }
+    int64_t resolutionUs = (uncertaintyUs > 0) ? (int64_t)uncertaintyUs * 2 : sourceResolutionUs[sampleSource];
+    bool worse = sampleSource < source ||
+                 (sampleSource == source && resolutionUs / 2 > getUncertaintyUs());
+    if (synced && worse && !needsResync()) {
+        stats.ignored++;
+        return false;
+    }
+
+    int64_t sampleUs = (int64_t)epochMs * 1000;
+    if (synced) {
+        int64_t offsetUs = sampleUs - predictUs(ticksUs);
+        stats.lastOffsetMs = (int32_t)(offsetUs / 1000);
+
+        // Residual offset over a long enough baseline refines the drift;
+        // the baseline restarts whenever the source changes
+        if (sampleSource == source) {
+            driftRefOffsetUs += offsetUs;
+            if (resolutionUs > driftRefResolutionUs) {
+                driftRefResolutionUs = resolutionUs;
+            }
+            int64_t baselineUs = ticksUs - driftRefTicksUs;
+            if (baselineUs > 0 && baselineUs >= driftRefResolutionUs * 200000LL) {
+                int64_t correctionPpb = driftRefOffsetUs * 1000000000LL / baselineUs;
+                int64_t newPpb = driftPpb + correctionPpb;
+                if (newPpb > -CLOCK_MAX_DRIFT_PPM * 1000LL && newPpb < CLOCK_MAX_DRIFT_PPM * 1000LL) {
+                    driftPpb = newPpb;
+                    driftValid = true;
+                }
+                driftRefTicksUs = ticksUs;
+                driftRefOffsetUs = 0;
+                driftRefResolutionUs = resolutionUs;
+            }
+        } else {
+            driftRefTicksUs = ticksUs;
+            driftRefOffsetUs = 0;
+            driftRefResolutionUs = resolutionUs;
+        }
+    } else {
+        driftRefTicksUs = ticksUs;
+        driftRefOffsetUs = 0;
+        driftRefResolutionUs = resolutionUs;
+    }
+
+    baseTicksUs = ticksUs;
+    baseEpochUs = sampleUs;
+    source = sampleSource;
+    syncUncertaintyUs = (uint32_t)(resolutionUs / 2);
+    synced = true;
+    stats.syncs++;
+    stats.driftPpm = driftPpb / 1000.0f;
+    return true;
+}
+
+int64_t QuectelClock::nowUs() const {
+    return synced ? predictUs(quectelTicksUs()) : 0;
+}
+
+uint64_t QuectelClock::nowMs() const {
+    return synced ? (uint64_t)(predictUs(quectelTicksUs()) / 1000) : 0;
+}
+
+uint64_t QuectelClock::ticksToEpochMs(int64_t ticksUs) const {
+    return synced ? (uint64_t)(predictUs(ticksUs) / 1000) : 0;
+}
+
+unsigned long QuectelClock::getAgeMs() const {
+    return synced ? (unsigned long)((quectelTicksUs() - baseTicksUs) / 1000) : ULONG_MAX;
+}
+
+uint32_t QuectelClock::getUncertaintyUs() const {
+    if (!synced) {
+        return UINT32_MAX;
+    }
+    int64_t elapsedUs = quectelTicksUs() - baseTicksUs;
+    int64_t holdoverUs = elapsedUs * (driftValid ? CLOCK_HOLDOVER_TRACKED_PPM : CLOCK_HOLDOVER_PPM) / 1000000;
+    int64_t totalUs = syncUncertaintyUs + holdoverUs;
+    return (totalUs < UINT32_MAX) ? (uint32_t)totalUs : UINT32_MAX;
+}
+
+bool QuectelClock::needsResync() const {
+    return !synced || quectelTicksUs() - baseTicksUs >= (int64_t)resyncIntervalMs * 1000;
+}
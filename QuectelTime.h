@@ -0,0 +1,222 @@
+/**
+ * QuectelTime.h - Allocation-free calendar arithmetic for QuectelEC200U
+ *
+ * Converts broken-down UTC dates to Unix epoch values without mktime(),
+ * timegm() or the TZ environment. The day count uses the era-based
+ * days-from-civil algorithm (proleptic Gregorian calendar), which is exact
+ * for any year and needs no lookup tables. The conversions are constexpr,
+ * so constant dates fold at compile time.
+ *
+ * QuectelClock keeps UTC locally between syncs: it maps a 64-bit tick
+ * counter to epoch time and corrects the local oscillator's drift, so
+ * reading the time costs no AT round trip.
+ *
+ * Author: ESP32 Arduino Library
+ * Date: 2024
+ */
+
+#ifndef QUECTEL_TIME_H
+#define QUECTEL_TIME_H
+
+#include <Arduino.h>
+
+// Days-from-civil steps; split up because C++11 constexpr allows a single return
+constexpr int32_t quectelCivilEra(int32_t y) {
+    return (y >= 0 ? y : y - 399) / 400;
+}
+
+constexpr int32_t quectelDayOfYear(uint32_t m, uint32_t d) {
+    return (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;  // March-based
+}
+
+constexpr int32_t quectelDayOfEra(int32_t yoe, int32_t doy) {
+    return yoe * 365 + yoe / 4 - yoe / 100 + doy;
+}
+
+constexpr int32_t quectelDaysFromShiftedYear(int32_t y, uint32_t m, uint32_t d) {
+    return quectelCivilEra(y) * 146097 +
+           quectelDayOfEra(y - quectelCivilEra(y) * 400, quectelDayOfYear(m, d)) - 719468;
+}
+
+/**
+ * Days since 1970-01-01
+ * @param year Full year (e.g. 2024)
+ * @param month 1-12
+ * @param day 1-31
+ */
+constexpr int32_t quectelDaysFromCivil(int32_t year, uint32_t month, uint32_t day) {
+    return quectelDaysFromShiftedYear(month <= 2 ? year - 1 : year, month, day);
+}
+
+/**
+ * Unix epoch in seconds for a UTC date and time
+ */
+constexpr int64_t quectelEpochSeconds(int32_t year, uint32_t month, uint32_t day,
+                                      uint32_t hour, uint32_t minute, uint32_t second) {
+    return (int64_t)quectelDaysFromCivil(year, month, day) * 86400 +
+           (int64_t)hour * 3600 + minute * 60 + second;
+}
+
+/**
+ * Unix epoch in milliseconds for a UTC date and time
+ */
+constexpr uint64_t quectelEpochMs(int32_t year, uint32_t month, uint32_t day,
+                                  uint32_t hour, uint32_t minute, uint32_t second,
+                                  uint32_t millisecond = 0) {
+    return (uint64_t)quectelEpochSeconds(year, month, day, hour, minute, second) * 1000 + millisecond;
+}
+
+/**
+ * Unix epoch in milliseconds for a local date and time
+ * @param timezone Offset of the local time from UTC in quarters of an hour
+ *                 (as reported by +QLTS/+CCLK, -48 to +56)
+ */
+constexpr uint64_t quectelZonedEpochMs(int32_t year, uint32_t month, uint32_t day,
+                                       uint32_t hour, uint32_t minute, uint32_t second,
+                                       int32_t timezone) {
+    return (uint64_t)(quectelEpochSeconds(year, month, day, hour, minute, second) -
+                      (int64_t)timezone * 900) * 1000;
+}
+
+static_assert(quectelDaysFromCivil(1970, 1, 1) == 0, "epoch origin");
+static_assert(quectelDaysFromCivil(1969, 12, 31) == -1, "before epoch");
+static_assert(quectelDaysFromCivil(2000, 2, 29) == 11016, "leap century");
+static_assert(quectelDaysFromCivil(2000, 3, 1) == 11017, "leap century");
+static_assert(quectelDaysFromCivil(2100, 3, 1) - quectelDaysFromCivil(2100, 2, 28) == 1, "2100 not leap");
+static_assert(quectelDaysFromCivil(2024, 1, 1) - quectelDaysFromCivil(2023, 1, 1) == 365, "common year");
+static_assert(quectelDaysFromCivil(2025, 1, 1) - quectelDaysFromCivil(2024, 1, 1) == 366, "leap year");
+static_assert(quectelEpochSeconds(2024, 2, 29, 12, 0, 0) == 1709208000LL, "leap day");
+static_assert(quectelEpochSeconds(2038, 1, 19, 3, 14, 8) == 2147483648LL, "past 32-bit time_t");
+static_assert(quectelZonedEpochMs(2024, 3, 1, 1, 30, 15, 8) ==
+              quectelEpochMs(2024, 2, 29, 23, 30, 15), "zone crosses leap day");
+static_assert(quectelZonedEpochMs(2024, 1, 1, 5, 45, 0, 23) ==
+              quectelEpochMs(2024, 1, 1, 0, 0, 0), "quarter-hour zone (+05:45)");
+static_assert(quectelZonedEpochMs(2023, 12, 31, 20, 30, 0, -14) ==
+              quectelEpochMs(2024, 1, 1, 0, 0, 0), "negative half-hour zone (-03:30)");
+
+/**
+ * Parse NMEA/QGPSLOC time and date fields into a Unix epoch
+ *
+ * The fields may be terminated by ',', '*', CR or NUL, so they can point
+ * straight into a sentence. Two-digit years map to 2000-2079 and 1980-1999.
+ *
+ * @param utcTime "hhmmss" or "hhmmss.s[ss]"
+ * @param date "ddmmyy"
+ * @return Milliseconds since 1970-01-01 UTC, or 0 if either field is malformed
+ */
+uint64_t quectelParseNMEATime(const char* utcTime, const char* date);
+
+/**
+ * Convert days since 1970-01-01 back to a calendar date
+ */
+void quectelCivilFromDays(int32_t days, int& year, int& month, int& day);
+
+/**
+ * Monotonic 64-bit microsecond tick counter
+ * esp_timer on ESP32, otherwise millis() extended past its 32-bit wrap
+ * (call at least once every 49 days).
+ */
+int64_t quectelTicksUs();
+
+// Clock Source (ordered by accuracy)
+enum ClockSource {
+    CLOCK_SOURCE_NONE = 0,
+    CLOCK_SOURCE_RTC = 1,      // Modem RTC (AT+CCLK), 1 s resolution
+    CLOCK_SOURCE_NITZ = 2,     // Network time (AT+QLTS), 1 s resolution
+    CLOCK_SOURCE_NTP = 3,      // NTP through the modem
+    CLOCK_SOURCE_GNSS = 4      // GNSS fix time
+};
+
+// Software Clock Statistics
+struct QuectelClockStats {
+    uint32_t syncs;            // Samples accepted
+    uint32_t ignored;          // Samples from a worse source than the current one
+    int32_t lastOffsetMs;      // Sample minus local prediction at the last sync
+    float driftPpm;            // Estimated local oscillator error (+ = local runs slow)
+};
+
+class QuectelClock {
+private:
+    bool synced;
+    ClockSource source;
+    int64_t baseTicksUs;       // Local ticks at the last sync
+    int64_t baseEpochUs;       // UTC at the last sync
+    int64_t driftPpb;          // Correction applied to elapsed ticks
+    int64_t driftRefTicksUs;   // Start of the current drift baseline
+    int64_t driftRefOffsetUs;  // Accumulated correction error over the baseline
+    int64_t driftRefResolutionUs; // Coarsest sample resolution within the baseline
+    bool driftValid;           // driftPpb comes from at least one full baseline
+    uint32_t syncUncertaintyUs; // Uncertainty of the last accepted sample
+    int16_t timezone;          // Quarters of an hour from UTC
+    unsigned long resyncIntervalMs;
+    QuectelClockStats stats;
+
+    int64_t predictUs(int64_t ticksUs) const;
+
+public:
+    QuectelClock();
+
+    /**
+     * Feed a time sample
+     *
+     * A sample from a worse source than the current one, or from the same
+     * source but less certain than the clock already is, is ignored unless
+     * the clock is due for a resync. The drift estimate is refined once the
+     * baseline since the drift reference is long enough for the samples'
+     * resolution (about 2 days for 1 s sources, minutes for GNSS).
+     *
+     * @param epochMs UTC at the moment the sample was taken, in ms
+     * @param ticksUs quectelTicksUs() at that moment
+     * @param source Where the sample came from
+     * @param uncertaintyUs Error bound of the sample, 0 for the source's default
+     * @return true if the sample was applied
+     */
+    bool sync(uint64_t epochMs, int64_t ticksUs, ClockSource source, uint32_t uncertaintyUs = 0);
+
+    /**
+     * Current UTC in ms (0 if never synced)
+     */
+    uint64_t nowMs() const;
+
+    /**
+     * Current UTC in µs (0 if never synced)
+     */
+    int64_t nowUs() const;
+
+    /**
+     * Convert a past or future tick value to UTC in ms (0 if never synced)
+     */
+    uint64_t ticksToEpochMs(int64_t ticksUs) const;
+
+    /**
+     * Time since the last accepted sample in ms (ULONG_MAX if never synced)
+     */
+    unsigned long getAgeMs() const;
+
+    /**
+     * Error bound of nowMs(): the last sample's uncertainty plus holdover
+     * drift since (20 ppm until the drift is estimated, then 2 ppm)
+     * @return µs, UINT32_MAX if never synced
+     */
+    uint32_t getUncertaintyUs() const;
+
+    /**
+     * Check whether the resync interval has elapsed since the last sync
+     */
+    bool needsResync() const;
+
+    void setResyncInterval(unsigned long ms) { resyncIntervalMs = ms; }
+    void setTimezone(int quarters) { timezone = quarters; }
+    int getTimezone() const { return timezone; }
+
+    /**
+     * Forget the time base and drift estimate
+     */
+    void reset();
+
+    bool isSynced() const { return synced; }
+    ClockSource getSource() const { return source; }
+    const QuectelClockStats& getStats() const { return stats; }
+};
+
+#endif // QUECTEL_TIME_H
@@ -0,0 +1,157 @@
+/**
+ * QuectelTrace.cpp - Binary AT traffic trace for QuectelEC200U
+ *
+ * Author: ESP32 Arduino Library
+ * Date: 2024
+ */
+
+#include "QuectelTrace.h"
+#include "QuectelTime.h"
+
+#if QUECTEL_TRACE
+
+#define TRACE_MASK (QUECTEL_TRACE_BUFFER - 1)
+
+QuectelTrace::QuectelTrace() : head(0), tail(0), dropped(0), enabled(true) {
+}
+
+void QuectelTrace::copyIn(uint32_t position, const void* data, size_t length) {
+    size_t offset = position & TRACE_MASK;
+    size_t first = QUECTEL_TRACE_BUFFER - offset;
+    if (first > length) {
+        first = length;
+    }
+    memcpy(buffer + offset, data, first);
+    memcpy(buffer, (const uint8_t*)data + first, length - first);
+}
+
+void QuectelTrace::copyOut(uint32_t position, void* data, size_t length) const {
+    size_t offset = position & TRACE_MASK;
+    size_t first = QUECTEL_TRACE_BUFFER - offset;
+    if (first > length) {
+        first = length;
+    }
+    memcpy(data, buffer + offset, first);
+    memcpy((uint8_t*)data + first, buffer, length - first);
+}
+
+bool QuectelTrace::record(QuectelTraceDirection direction, const char* data, size_t length) {
+    if (!enabled) {
+        return false;
+    }
+
+    QuectelTraceRecord header;
+    header.timeUs = (uint32_t)quectelTicksUs();
+    header.length = (length > QUECTEL_TRACE_MAX_PAYLOAD) ? QUECTEL_TRACE_MAX_PAYLOAD : length;
+    header.direction = direction;
+    header.flags = (length > header.length) ? QUECTEL_TRACE_TRUNCATED : 0;
+
+    // Only this side moves head; tail is published by the reader
+    uint32_t position = head.load(std::memory_order_relaxed);
+    uint32_t used = position - tail.load(std::memory_order_acquire);
+    if (QUECTEL_TRACE_BUFFER - used < sizeof(header) + header.length) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    copyIn(position, &header, sizeof(header));
+    copyIn(position + sizeof(header), data, header.length);
+    head.store(position + sizeof(header) + header.length, std::memory_order_release);
+    return true;
+}
+
+bool QuectelTrace::read(QuectelTraceRecord& header, uint8_t* payload, size_t payloadSize) {
+    uint32_t position = tail.load(std::memory_order_relaxed);
+    if (position == head.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    copyOut(position, &header, sizeof(header));
+    copyOut(position + sizeof(header), payload, (header.length < payloadSize) ? header.length : payloadSize);
+    tail.store(position + sizeof(header) + header.length, std::memory_order_release);
+    return true;
+}
+
+size_t QuectelTrace::drain(uint8_t* out, size_t size) {
+    uint32_t position = tail.load(std::memory_order_relaxed);
+    uint32_t end = head.load(std::memory_order_acquire);
+    size_t written = 0;
+
+    while (position != end) {
+        QuectelTraceRecord header;
+        copyOut(position, &header, sizeof(header));
+        size_t recordSize = sizeof(header) + header.length;
+        if (written + recordSize > size) {
+            break;
+        }
+        copyOut(position, out + written, recordSize);
+        written += recordSize;
+        position += recordSize;
+    }
+
+    tail.store(position, std::memory_order_release);
+    return written;
+}
+
+// Print one record as "<seconds>.<µs> >> text"
+static void printRecord(const QuectelTraceRecord& header, const uint8_t* payload, Print& out) {
+    static const char* const arrows[] = { ">> ", "<< ", "!! " };
+    char prefix[24];
+    snprintf(prefix, sizeof(prefix), "%lu.%06lu ", (unsigned long)(header.timeUs / 1000000),
+             (unsigned long)(header.timeUs % 1000000));
+    out.print(prefix);
+    out.print(header.direction <= TRACE_URC ? arrows[header.direction] : "?? ");
+
+    for (uint16_t i = 0; i < header.length; i++) {
+        uint8_t c = payload[i];
+        if (c == '\r') {
+            out.print("\\r");
+        } else if (c == '\n') {
+            out.print("\\n");
+        } else if (c < 0x20 || c >= 0x7F) {
+            char escaped[5];
+            snprintf(escaped, sizeof(escaped), "\\x%02X", c);
+            out.print(escaped);
+        } else {
+            out.write(c);
+        }
+    }
+    if (header.flags & QUECTEL_TRACE_TRUNCATED) {
+        out.print("...");
+    }
+    out.println();
+}
+
+size_t QuectelTrace::decode(const uint8_t* data, size_t length, Print& out) {
+    size_t records = 0;
+    size_t offset = 0;
+    while (offset + sizeof(QuectelTraceRecord) <= length) {
+        QuectelTraceRecord header;
+        memcpy(&header, data + offset, sizeof(header));
+        offset += sizeof(header);
+        if (offset + header.length > length) {
+            break;  // Cut-off record
+        }
+        printRecord(header, data + offset, out);
+        offset += header.length;
+        records++;
+    }
+    return records;
+}
+
+size_t QuectelTrace::dump(Print& out) {
+    QuectelTraceRecord header;
+    uint8_t payload[QUECTEL_TRACE_MAX_PAYLOAD];
+    size_t records = 0;
+    while (read(header, payload, sizeof(payload))) {
+        printRecord(header, payload, out);
+        records++;
+    }
+    return records;
+}
+
+void QuectelTrace::clear() {
+    tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+#endif // QUECTEL_TRACE
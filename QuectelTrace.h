@@ -0,0 +1,137 @@
+/**
+ * QuectelTrace.h - Binary AT traffic trace for QuectelEC200U
+ *
+ * Commands, responses and unsolicited lines are appended to a fixed ring
+ * buffer as compact binary records (timestamp, direction, length, bytes)
+ * instead of being printed to Serial while the modem waits. Writing costs
+ * a memcpy, so tracing can stay on in production; the buffer is read
+ * later with read(), shipped raw with drain() or printed with dump().
+ *
+ * The ring is single-producer/single-consumer and lock-free: the task
+ * talking to the modem records, one other task (or the same one) reads.
+ * When the buffer is full new records are dropped and counted, so the
+ * producer never waits for the reader.
+ *
+ * Build with QUECTEL_TRACE=0 to compile tracing out.
+ *
+ * Author: ESP32 Arduino Library
+ * Date: 2024
+ */
+
+#ifndef QUECTEL_TRACE_H
+#define QUECTEL_TRACE_H
+
+#include <Arduino.h>
+#include <atomic>
+
+#ifndef QUECTEL_TRACE
+#define QUECTEL_TRACE 1
+#endif
+
+// Ring buffer size in bytes (power of two)
+#ifndef QUECTEL_TRACE_BUFFER
+#define QUECTEL_TRACE_BUFFER 2048
+#endif
+
+// Bytes kept per record; longer payloads are cut and flagged
+#ifndef QUECTEL_TRACE_MAX_PAYLOAD
+#define QUECTEL_TRACE_MAX_PAYLOAD 128
+#endif
+
+#define QUECTEL_TRACE_TRUNCATED 0x01
+
+static_assert((QUECTEL_TRACE_BUFFER & (QUECTEL_TRACE_BUFFER - 1)) == 0,
+              "QUECTEL_TRACE_BUFFER must be a power of two");
+
+// Trace Direction
+enum QuectelTraceDirection {
+    TRACE_TX = 0,              // Command sent
+    TRACE_RX = 1,              // Response to a command
+    TRACE_URC = 2              // Unsolicited line read between commands
+};
+
+// Record header, stored in the ring ahead of its payload
+struct QuectelTraceRecord {
+    uint32_t timeUs;           // Low 32 bits of quectelTicksUs() (wraps every 71 min)
+    uint16_t length;           // Payload bytes stored
+    uint8_t direction;         // QuectelTraceDirection
+    uint8_t flags;             // QUECTEL_TRACE_TRUNCATED
+};
+
+static_assert(sizeof(QuectelTraceRecord) == 8, "trace header must be packed");
+
+class QuectelTrace {
+private:
+    uint8_t buffer[QUECTEL_TRACE_BUFFER];
+    std::atomic<uint32_t> head;    // Free-running write position (producer)
+    std::atomic<uint32_t> tail;    // Free-running read position (consumer)
+    std::atomic<uint32_t> dropped;
+    bool enabled;
+
+    void copyIn(uint32_t position, const void* data, size_t length);
+    void copyOut(uint32_t position, void* data, size_t length) const;
+
+public:
+    QuectelTrace();
+
+    /**
+     * Append a record (producer side)
+     * @param direction TRACE_TX, TRACE_RX or TRACE_URC
+     * @param data Bytes to store (need not be null terminated)
+     * @param length Bytes; at most QUECTEL_TRACE_MAX_PAYLOAD are kept
+     * @return false if tracing is off or the record did not fit
+     */
+    bool record(QuectelTraceDirection direction, const char* data, size_t length);
+
+    /**
+     * Remove the oldest record (consumer side)
+     * @param header Receives the record header
+     * @param payload Receives up to payloadSize payload bytes
+     * @param payloadSize Size of payload
+     * @return false if the trace is empty
+     */
+    bool read(QuectelTraceRecord& header, uint8_t* payload, size_t payloadSize);
+
+    /**
+     * Move whole records to a buffer in their binary form (consumer side)
+     * The output can be stored or uploaded and printed later with decode().
+     * @return Bytes written (0 if empty or out is smaller than the oldest record)
+     */
+    size_t drain(uint8_t* out, size_t size);
+
+    /**
+     * Print binary records produced by drain() as text, one line per record:
+     * "<seconds>.<µs> >> AT+CSQ" (<< response, !! unsolicited), control
+     * characters escaped and "..." after truncated payloads
+     * @return Records printed
+     */
+    static size_t decode(const uint8_t* data, size_t length, Print& out);
+
+    /**
+     * Print and remove all records (consumer side)
+     * @return Records printed
+     */
+    size_t dump(Print& out);
+
+    /**
+     * Discard all records (consumer side)
+     */
+    void clear();
+
+    void setEnabled(bool enable) { enabled = enable; }
+    bool isEnabled() const { return enabled; }
+
+    /**
+     * Records lost because the buffer was full
+     */
+    uint32_t getDropped() const { return dropped.load(std::memory_order_relaxed); }
+
+    /**
+     * Bytes waiting to be read
+     */
+    size_t getUsed() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_relaxed);
+    }
+};
+
+#endif // QUECTEL_TRACE_H
@@ -0,0 +1,121 @@
+/**
+ * TrackSimplifier.cpp - Online track simplification for QuectelEC200U GNSS fixes
+ *
+ * Author: ESP32 Arduino Library
+ * Date: 2024
+ */
+
+#include "TrackSimplifier.h"
+
+#define METERS_PER_DEG_LAT 111319.49f
+
+TrackSimplifier::TrackSimplifier(float toleranceMeters) {
+    tolerance = toleranceMeters;
+    maxIntervalMs = 0;
+    callback = nullptr;
+    callbackContext = nullptr;
+    inputCount = 0;
+    outputCount = 0;
+    reset();
+}
+
+void TrackSimplifier::reset() {
+    hasAnchor = false;
+    windowCount = 0;
+}
+
+void TrackSimplifier::emit(const TrackPoint& point) {
+    outputCount++;
+    if (callback != nullptr) {
+        callback(point, callbackContext);
+    }
+}
+
+void TrackSimplifier::setAnchor(const TrackPoint& point) {
+    anchor = point;
+    anchorMetersPerDegLon = METERS_PER_DEG_LAT * cosf((float)point.latitude * (float)DEG_TO_RAD);
+    hasAnchor = true;
+    windowCount = 0;
+}
+
+bool TrackSimplifier::windowFitsSegment(float bx, float by) const {
+    // Distance of each pending point to the segment anchor -> (bx, by)
+    float len2 = bx * bx + by * by;
+    float tol2 = tolerance * tolerance;
+
+    for (uint8_t i = 0; i < windowCount; i++) {
+        float qx = window[i].x;
+        float qy = window[i].y;
+        float t = 0;
+        if (len2 > 0) {
+            t = (qx * bx + qy * by) / len2;
+            t = (t < 0) ? 0 : ((t > 1) ? 1 : t);
+        }
+        float dx = qx - t * bx;
+        float dy = qy - t * by;
+        if (dx * dx + dy * dy > tol2) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TrackSimplifier::add(const TrackPoint& point) {
+    inputCount++;
+
+    if (!hasAnchor) {
+        setAnchor(point);
+        emit(point);
+        return true;
+    }
+
+    bool emitted = false;
+    float bx = (float)(point.longitude - anchor.longitude) * anchorMetersPerDegLon;
+    float by = (float)(point.latitude - anchor.latitude) * METERS_PER_DEG_LAT;
+
+    // The newest pending point becomes a vertex when the line to the new fix
+    // no longer explains every point in between
+    if (windowCount > 0 && !windowFitsSegment(bx, by)) {
+        TrackPoint vertex = window[windowCount - 1].point;
+        setAnchor(vertex);
+        emit(vertex);
+        emitted = true;
+        bx = (float)(point.longitude - anchor.longitude) * anchorMetersPerDegLon;
+        by = (float)(point.latitude - anchor.latitude) * METERS_PER_DEG_LAT;
+    }
+
+    bool intervalExpired = (maxIntervalMs > 0 && point.timestamp - anchor.timestamp >= maxIntervalMs);
+    if (intervalExpired || windowCount >= TRACK_SIMPLIFIER_WINDOW) {
+        setAnchor(point);
+        emit(point);
+        return true;
+    }
+
+    window[windowCount].point = point;
+    window[windowCount].x = bx;
+    window[windowCount].y = by;
+    windowCount++;
+    return emitted;
+}
+
+bool TrackSimplifier::add(const GNSSPosition& position, unsigned long timestampMs) {
+    if (!position.valid) {
+        return false;
+    }
+    TrackPoint point;
+    point.latitude = position.latitude;
+    point.longitude = position.longitude;
+    point.timestamp = timestampMs;
+    point.speedKmh = position.speedKmh;
+    return add(point);
+}
+
+bool TrackSimplifier::flush() {
+    if (windowCount == 0) {
+        return false;
+    }
+    TrackPoint vertex = window[windowCount - 1].point;
+    setAnchor(vertex);
+    emit(vertex);
+    return true;
+}
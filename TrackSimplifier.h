@@ -0,0 +1,115 @@
+/**
+ * TrackSimplifier.h - Online track simplification for QuectelEC200U GNSS fixes
+ *
+ * Drops fixes that lie within a cross-track tolerance of the line between
+ * the last emitted vertex and the newest fix (opening-window Douglas-Peucker).
+ * Only significant vertices reach the callback, so an uploader batching
+ * its output sends a fraction of the raw fixes on straight stretches.
+ *
+ * Memory is bounded by TRACK_SIMPLIFIER_WINDOW pending points; when the
+ * window fills, the newest point is emitted regardless of tolerance.
+ *
+ * Author: ESP32 Arduino Library
+ * Date: 2024
+ */
+
+#ifndef TRACK_SIMPLIFIER_H
+#define TRACK_SIMPLIFIER_H
+
+#include "QuectelEC200U.h"
+
+// Maximum pending points between two emitted vertices
+#ifndef TRACK_SIMPLIFIER_WINDOW
+#define TRACK_SIMPLIFIER_WINDOW 32
+#endif
+
+// Track Point
+struct TrackPoint {
+    double latitude;        // Decimal degrees
+    double longitude;       // Decimal degrees
+    unsigned long timestamp; // ms
+    float speedKmh;
+};
+
+typedef void (*TrackPointCallback)(const TrackPoint& point, void* context);
+
+class TrackSimplifier {
+private:
+    struct Pending {
+        TrackPoint point;
+        float x, y;          // Metres east/north of the anchor
+    };
+
+    TrackPoint anchor;
+    bool hasAnchor;
+    float anchorMetersPerDegLon;
+    Pending window[TRACK_SIMPLIFIER_WINDOW];
+    uint8_t windowCount;
+
+    float tolerance;
+    unsigned long maxIntervalMs;
+    TrackPointCallback callback;
+    void* callbackContext;
+    uint32_t inputCount;
+    uint32_t outputCount;
+
+    void emit(const TrackPoint& point);
+    void setAnchor(const TrackPoint& point);
+    bool windowFitsSegment(float bx, float by) const;
+
+public:
+    /**
+     * Create a simplifier
+     * @param toleranceMeters Cross-track tolerance in metres (default 10)
+     */
+    TrackSimplifier(float toleranceMeters = 10.0);
+
+    /**
+     * Add a fix
+     * @param point Fix to add
+     * @return true if a vertex was emitted
+     */
+    bool add(const TrackPoint& point);
+
+    /**
+     * Add a fix from the modem (ignored if not valid)
+     * @param position Fix to add
+     * @param timestampMs Fix time in ms
+     * @return true if a vertex was emitted
+     */
+    bool add(const GNSSPosition& position, unsigned long timestampMs);
+
+    /**
+     * Emit the newest pending fix, e.g. at the end of a trip or before an upload
+     * @return true if a vertex was emitted
+     */
+    bool flush();
+
+    /**
+     * Drop all state; the next fix is emitted as a new starting vertex
+     */
+    void reset();
+
+    /**
+     * Set the vertex callback
+     * @param cb Function called for every emitted vertex
+     * @param context User pointer passed to the callback
+     */
+    void setCallback(TrackPointCallback cb, void* context = nullptr) {
+        callback = cb;
+        callbackContext = context;
+    }
+
+    void setTolerance(float toleranceMeters) { tolerance = toleranceMeters; }
+
+    /**
+     * Emit a vertex at least this often even on a straight line
+     * @param ms Maximum time between vertices (0 = no limit, default)
+     */
+    void setMaxInterval(unsigned long ms) { maxIntervalMs = ms; }
+
+    uint32_t getInputCount() const { return inputCount; }
+    uint32_t getOutputCount() const { return outputCount; }
+};
+
+#endif // TRACK_SIMPLIFIER_H